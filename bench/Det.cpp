@@ -0,0 +1,101 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+template <typename T> static mmm::Matrix<T> randomMatrix(size_t dim) {
+  std::mt19937 rand{42};
+  mmm::Matrix<T> m(dim);
+  std::ranges::generate(m, [&rand] { return T(int(rand() % 21) - 10); });
+  return m;
+}
+
+// Elimination does 2/3 n^3 multiply-adds whatever the engine
+static void setCounters(benchmark::State &state, size_t dim, size_t elem) {
+  double n = static_cast<double>(dim);
+  state.counters["FLOP/s"] = benchmark::Counter(
+      2.0 / 3 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+  state.SetBytesProcessed(state.iterations() * dim * dim * elem);
+}
+
+// Through view(), Matrix would answer from cached factorization
+template <typename T> static void BM_Det(benchmark::State &state) {
+  size_t dim = state.range(0);
+  auto m = randomMatrix<T>(dim);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(m.view().det());
+  setCounters(state, dim, sizeof(T));
+}
+
+// Exact determinants of random integral matrices don't fit into int, so
+// detBig() is measured
+static void BM_DetBigInt(benchmark::State &state) {
+  size_t dim = state.range(0);
+  auto m = randomMatrix<int>(dim);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(m.detBig());
+  setCounters(state, dim, sizeof(int));
+}
+
+// Float LU with double pivot product against BM_Det<double>
+static void BM_DetMixed(benchmark::State &state) {
+  size_t dim = state.range(0);
+  auto m = randomMatrix<double>(dim);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(m.detMixed({}, 1));
+  setCounters(state, dim, sizeof(double));
+}
+
+// Substitutions with cached factorization, 2 n^2 multiply-adds
+static void BM_Solve(benchmark::State &state) {
+  size_t dim = state.range(0);
+  auto m = randomMatrix<double>(dim);
+  mmm::FixedVector<double> b(dim);
+  std::fill(b.begin(), b.end(), 1.0);
+  m.lu();
+  for (auto _ : state)
+    benchmark::DoNotOptimize(m.solve(b));
+  double n = static_cast<double>(dim);
+  state.counters["FLOP/s"] = benchmark::Counter(
+      2.0 * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_DetBigInt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 9)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Det<float>)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 12)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Det<double>)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 12)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DetMixed)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 12)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Solve)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 12)
+    ->Unit(benchmark::kMicrosecond);
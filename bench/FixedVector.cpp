@@ -0,0 +1,58 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <FixedVector.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+
+static void BM_FixedVectorCtor(benchmark::State &state) {
+  size_t n = state.range(0);
+  for (auto _ : state) {
+    mmm::FixedVector<double> v(n);
+    benchmark::DoNotOptimize(v.begin());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_FixedVectorFill(benchmark::State &state) {
+  size_t n = state.range(0);
+  for (auto _ : state) {
+    mmm::FixedVector<double> v(n);
+    std::fill(v.begin(), v.end(), 1.0);
+    benchmark::DoNotOptimize(v.begin());
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+
+static void BM_FixedVectorCopy(benchmark::State &state) {
+  size_t n = state.range(0);
+  mmm::FixedVector<double> src(n);
+  std::fill(src.begin(), src.end(), 1.0);
+  for (auto _ : state) {
+    mmm::FixedVector<double> v(src);
+    benchmark::DoNotOptimize(v.begin());
+  }
+  // Read and write of every element
+  state.SetBytesProcessed(state.iterations() * 2 * n * sizeof(double));
+}
+
+BENCHMARK(BM_FixedVectorCtor)->RangeMultiplier(16)->Range(1 << 6, 1 << 24);
+BENCHMARK(BM_FixedVectorFill)->RangeMultiplier(16)->Range(1 << 6, 1 << 24);
+BENCHMARK(BM_FixedVectorCopy)->RangeMultiplier(16)->Range(1 << 6, 1 << 24);
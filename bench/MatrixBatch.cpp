@@ -0,0 +1,61 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <MatrixBatch.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Throughput of many small determinants, lane-parallel against one by one
+template <bool Batched> static void BM_BatchDet(benchmark::State &state) {
+  size_t dim = state.range(0);
+  size_t count = state.range(1);
+  std::mt19937 rand{42};
+  std::uniform_real_distribution<double> dist(-1, 1);
+  mmm::MatrixBatch<double> batch(count, dim);
+  for (size_t b = 0; b < count; ++b)
+    for (size_t i = 0; i < dim; ++i)
+      for (size_t j = 0; j < dim; ++j)
+        batch(b, i, j) = dist(rand);
+
+  std::vector<mmm::Matrix<double>> single;
+  if constexpr (!Batched)
+    for (size_t b = 0; b < count; ++b)
+      single.push_back(batch.matrix(b));
+
+  for (auto _ : state)
+    if constexpr (Batched)
+      benchmark::DoNotOptimize(batch.detBatch());
+    else
+      for (auto &m : single)
+        benchmark::DoNotOptimize(m.view().det());
+
+  double n = static_cast<double>(dim);
+  state.counters["FLOP/s"] =
+      benchmark::Counter(2.0 / 3 * n * n * n * count,
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_BatchDet<true>)
+    ->ArgsProduct({{2, 3, 4, 8, 16, 32}, {4096}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BatchDet<false>)
+    ->ArgsProduct({{2, 3, 4, 8, 16, 32}, {4096}})
+    ->Unit(benchmark::kMicrosecond);
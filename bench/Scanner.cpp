@@ -0,0 +1,63 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Scanner.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+template <typename T> static const std::string &matrixText() {
+  static const std::string text = [] {
+    constexpr size_t dim = 1024;
+    std::mt19937 rand{42};
+    std::uniform_real_distribution<double> dist(-1000, 1000);
+    std::ostringstream oss;
+    oss << dim << '\n';
+    for (size_t i = 0; i < dim * dim; ++i) {
+      oss << T(dist(rand));
+      oss << ((i + 1) % dim ? ' ' : '\n');
+    }
+    return oss.str();
+  }();
+  return text;
+}
+
+// range(0) is number of threads, 0 for all hardware threads
+template <typename T> static void BM_Scanner(benchmark::State &state) {
+  const auto &text = matrixText<T>();
+  mmm::ScanPolicy policy{.threads = static_cast<unsigned>(state.range(0))};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mmm::magicScanner<T>(text, policy));
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_ScannerIstream(benchmark::State &state) {
+  const auto &text = matrixText<double>();
+  for (auto _ : state) {
+    std::istringstream iss(text);
+    benchmark::DoNotOptimize(mmm::magicScanner<double>(iss));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_Scanner<int>)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Scanner<double>)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScannerIstream)->Unit(benchmark::kMillisecond);
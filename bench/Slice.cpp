@@ -0,0 +1,93 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <FixedVector.hpp>
+#include <Slice.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+
+// Slices of n elements with stride range(0) over buffers of n * stride
+class SliceFixture : public benchmark::Fixture {
+public:
+  static constexpr size_t n = size_t{1} << 16;
+
+  void SetUp(const benchmark::State &state) override {
+    stride = state.range(0);
+    x = mmm::FixedVector<double>(n * stride);
+    y = mmm::FixedVector<double>(n * stride);
+    std::fill(x.begin(), x.end(), 1.0);
+    std::fill(y.begin(), y.end(), 2.0);
+  }
+
+  auto slice(mmm::FixedVector<double> &v) {
+    return mmm::Slice<double>(v.begin(), v.size(), 0, stride, n);
+  }
+
+  // Every element of y is read and written, x is read if binary
+  void setCounters(benchmark::State &state, size_t streams) {
+    state.counters["FLOP/s"] =
+        benchmark::Counter(n, benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * streams * n * sizeof(double));
+  }
+
+  size_t stride;
+  mmm::FixedVector<double> x, y;
+};
+
+BENCHMARK_DEFINE_F(SliceFixture, AddAssign)(benchmark::State &state) {
+  auto sx = slice(x), sy = slice(y);
+  for (auto _ : state) {
+    sy += sx;
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, 3);
+}
+
+BENCHMARK_DEFINE_F(SliceFixture, MulAssignScalar)(benchmark::State &state) {
+  auto sy = slice(y);
+  for (auto _ : state) {
+    sy *= 1.0000001;
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, 2);
+}
+
+BENCHMARK_DEFINE_F(SliceFixture, AddAssignExpr)(benchmark::State &state) {
+  auto sx = slice(x), sy = slice(y);
+  for (auto _ : state) {
+    sy += sx * 0.5 + sx;
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, 3);
+}
+
+BENCHMARK_DEFINE_F(SliceFixture, FmaSub)(benchmark::State &state) {
+  auto sx = slice(x), sy = slice(y);
+  for (auto _ : state) {
+    sy.fmaSub(1e-9, sx);
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, 3);
+}
+
+BENCHMARK_REGISTER_F(SliceFixture, AddAssign)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK_REGISTER_F(SliceFixture, MulAssignScalar)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK_REGISTER_F(SliceFixture, AddAssignExpr)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK_REGISTER_F(SliceFixture, FmaSub)->Arg(1)->Arg(4)->Arg(16);
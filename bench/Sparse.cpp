@@ -0,0 +1,69 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <SparseMatrix.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// 5-point Laplacian on k x k grid
+static mmm::SparseMatrix<double> gridLaplacian(size_t k) {
+  std::vector<mmm::Triplet<double>> t;
+  for (size_t i = 0; i < k; ++i)
+    for (size_t j = 0; j < k; ++j) {
+      size_t v = i * k + j;
+      t.push_back({v, v, 4});
+      if (i + 1 < k) {
+        t.push_back({v, v + k, -1});
+        t.push_back({v + k, v, -1});
+      }
+      if (j + 1 < k) {
+        t.push_back({v, v + 1, -1});
+        t.push_back({v + 1, v, -1});
+      }
+    }
+  return mmm::SparseMatrix<double>(k * k, t);
+}
+
+static void BM_SparseOrdering(benchmark::State &state) {
+  auto s = gridLaplacian(state.range(0));
+  size_t lnz = 0;
+  for (auto _ : state)
+    lnz = mmm::analyzeSparse(s.dim(), s.rowPtr().data(), s.colIdx().data())
+              .lnz;
+  state.counters["lnz"] = static_cast<double>(lnz);
+  state.SetItemsProcessed(state.iterations() * s.nnz());
+}
+
+static void BM_SparseSlogdet(benchmark::State &state) {
+  auto s = gridLaplacian(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s.slogdet());
+  state.counters["n"] = static_cast<double>(s.dim());
+  state.SetItemsProcessed(state.iterations() * s.nnz());
+}
+
+BENCHMARK(BM_SparseOrdering)
+    ->RangeMultiplier(2)
+    ->Range(16, 256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SparseSlogdet)
+    ->RangeMultiplier(2)
+    ->Range(16, 256)
+    ->Unit(benchmark::kMillisecond);
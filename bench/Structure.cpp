@@ -0,0 +1,72 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <Structure.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+enum Kind { Dense, Lower, Banded, BlockDiagonal };
+
+// Diagonally dominant, so every engine works on the same regular matrix
+static mmm::Matrix<double> structured(Kind kind, size_t dim) {
+  std::mt19937 rand{42};
+  std::uniform_real_distribution<double> dist(-1, 1);
+  mmm::Matrix<double> m(dim);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j) {
+      bool nonzero = kind == Dense || (kind == Lower && j <= i) ||
+                     (kind == Banded && j + 4 >= i && j <= i + 4) ||
+                     (kind == BlockDiagonal && i / 64 == j / 64);
+      m(i, j) = nonzero ? dist(rand) / dim : 0.0;
+    }
+  for (size_t i = 0; i < dim; ++i)
+    m(i, i) = 1;
+  return m;
+}
+
+// Cost of detection alone: O(n) for dense matrices, full pass for sparse
+static void BM_StructureScan(benchmark::State &state) {
+  size_t dim = state.range(1);
+  auto m = structured(static_cast<Kind>(state.range(0)), dim);
+  for (auto _ : state) {
+    auto band = mmm::bandwidths(m.begin(), dim, dim);
+    benchmark::DoNotOptimize(mmm::components(m.begin(), dim, dim, band));
+  }
+  state.SetBytesProcessed(state.iterations() * dim * dim * sizeof(double));
+}
+
+// range(2) selects StructureScan
+static void BM_DetStructure(benchmark::State &state) {
+  size_t dim = state.range(1);
+  auto m = structured(static_cast<Kind>(state.range(0)), dim);
+  mmm::DetPolicy policy{.structure = static_cast<mmm::StructureScan>(
+                            state.range(2))};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(m.view().det(policy));
+  state.SetBytesProcessed(state.iterations() * dim * dim * sizeof(double));
+}
+
+BENCHMARK(BM_StructureScan)
+    ->ArgsProduct({{Dense, Lower, Banded, BlockDiagonal}, {256, 1024, 4096}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DetStructure)
+    ->ArgsProduct({{Dense, Lower, Banded, BlockDiagonal}, {256, 1024}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,119 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace mmm { // my magic matrix
+
+// Allocates storage aligned to Align bytes, one cache line by default, so
+// vector kernels may use aligned loads from the first element
+template <typename T, size_t Align = 64> class AlignedAllocator {
+  static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0,
+                "Alignment must be a power of two not less than alignof(T)");
+
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Align>;
+  };
+
+  constexpr AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr AlignedAllocator(const AlignedAllocator<U, Align> &) noexcept {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t{Align}));
+  }
+
+  void deallocate(T *p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t{Align});
+  }
+
+  template <typename U>
+  constexpr bool operator==(const AlignedAllocator<U, Align> &) const noexcept {
+    return true;
+  }
+}; // class AlignedAllocator
+
+inline constexpr size_t huge_page_size = size_t{2} << 20;
+
+// Buffers of at least Threshold bytes are aligned and padded to whole 2 MiB
+// pages, and the kernel is asked to back them with transparent huge pages,
+// which saves TLB misses when walking large matrices. Smaller buffers are
+// cache line aligned.
+template <typename T, size_t Threshold = huge_page_size>
+class HugePageAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = HugePageAllocator<U, Threshold>;
+  };
+
+private:
+  static size_t hugeBytes(size_t n) noexcept {
+    size_t bytes = n * sizeof(T);
+    if (bytes < Threshold)
+      return 0;
+    return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+  }
+
+public:
+  constexpr HugePageAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr HugePageAllocator(
+      const HugePageAllocator<U, Threshold> &) noexcept {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    size_t bytes = hugeBytes(n);
+    if (!bytes)
+      return AlignedAllocator<T>().allocate(n);
+
+    void *p = ::operator new(bytes, std::align_val_t{huge_page_size});
+#ifdef MADV_HUGEPAGE
+    // Only a hint, allocation stays valid if THP are disabled
+    madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    return static_cast<T *>(p);
+  }
+
+  void deallocate(T *p, size_t n) noexcept {
+    if (!hugeBytes(n))
+      return AlignedAllocator<T>().deallocate(p, n);
+    ::operator delete(p, std::align_val_t{huge_page_size});
+  }
+
+  template <typename U>
+  constexpr bool
+  operator==(const HugePageAllocator<U, Threshold> &) const noexcept {
+    return true;
+  }
+}; // class HugePageAllocator
+
+} // namespace mmm
@@ -0,0 +1,179 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "ScratchPool.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <concepts>
+#include <numeric>
+#include <optional>
+#include <utility>
+
+namespace mmm { // my magic matrix
+
+#ifdef __SIZEOF_INT128__
+using Int128 = __int128;
+#else
+using Int128 = long long;
+#endif
+
+// True if x is representable in To without change of value or sign
+template <typename To, typename From>
+constexpr bool fitsInto(From x) noexcept {
+  To y = static_cast<To>(x);
+  return static_cast<From>(y) == x && ((y < To{}) == (x < From{}));
+}
+
+// Fraction-free (Bareiss) elimination over widened integers. Every division
+// is exact, so the result is exact unless some intermediate minor doesn't fit
+// into Wide; then std::nullopt is returned. Products are formed in Int128 and
+// checked, rows are permuted through an index vector as in BlockedLU.
+template <typename Wide> class Bareiss {
+  using Acc =
+      std::conditional_t<(sizeof(Wide) < sizeof(Int128)), Int128, Wide>;
+
+  ScratchVector<Wide> own_; // empty when eliminating in place
+  Wide *a_;
+  size_t n_;
+  size_t ld_;
+  ScratchVector<size_t> perm_;
+  ThreadPool *pool_;
+  std::atomic<bool> overflow_ = false;
+
+  Wide *row(size_t i) const noexcept {
+    return a_ + perm_.begin()[i] * ld_;
+  }
+
+  // (x * p - y * q) / prev, exact division
+  static bool update(Wide &res, Wide x, Wide p, Wide y, Wide q,
+                     Wide prev) noexcept {
+    Acc l, r, num;
+    if (__builtin_mul_overflow(Acc{x}, Acc{p}, &l) ||
+        __builtin_mul_overflow(Acc{y}, Acc{q}, &r) ||
+        __builtin_sub_overflow(l, r, &num))
+      return false;
+
+    // Cheap 64-bit division while values stay small
+    if (fitsInto<long long>(num) && fitsInto<long long>(prev)) {
+      res = static_cast<Wide>(static_cast<long long>(num) /
+                              static_cast<long long>(prev));
+      return true;
+    }
+
+    Acc quot = num / Acc{prev};
+    if (!fitsInto<Wide>(quot))
+      return false;
+    res = static_cast<Wide>(quot);
+    return true;
+  }
+
+  void eliminateRows(size_t k, Wide prev, size_t lo, size_t hi) {
+    const Wide *pk = row(k);
+    Wide p = pk[k];
+    for (size_t i = lo; i < hi && !overflow_.load(std::memory_order_relaxed);
+         ++i) {
+      Wide *ri = row(i);
+      Wide q = ri[k];
+      for (size_t j = k + 1; j < n_; ++j)
+        if (!update(ri[j], ri[j], p, q, pk[j], prev)) {
+          overflow_.store(true, std::memory_order_relaxed);
+          return;
+        }
+    }
+  }
+
+public:
+  template <std::integral T>
+  Bareiss(const T *src, size_t n, size_t ld, ThreadPool *pool = nullptr)
+      : own_(n * n), a_(own_.begin()), n_(n), ld_(n), perm_(n), pool_(pool) {
+    std::iota(perm_.begin(), perm_.end(), size_t{0});
+    ScopedTimer timer(Phase::Copy);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j) {
+        T x = src[i * ld + j];
+        if (!fitsInto<Wide>(x))
+          overflow_ = true;
+        a_[i * n + j] = static_cast<Wide>(x);
+      }
+  }
+
+  // Eliminates directly in a, destroying it. Products are still widened one
+  // by one, so only the minors themselves have to fit into Wide.
+  Bareiss(std::in_place_t, Wide *a, size_t n, size_t ld,
+          ThreadPool *pool = nullptr)
+      : a_(a), n_(n), ld_(ld), perm_(n), pool_(pool) {
+    std::iota(perm_.begin(), perm_.end(), size_t{0});
+  }
+
+  std::optional<Wide> det() {
+    if (overflow_)
+      return std::nullopt;
+
+    ScopedTimer timer(Phase::Eliminate);
+    auto &stats = Stats::global();
+    stats.add(Counter::Determinants);
+    auto *perm = perm_.begin();
+    Wide prev = 1;
+    bool negate = false;
+    for (size_t k = 0; k + 1 < n_; ++k) {
+      size_t p = k;
+      while (p < n_ && row(p)[k] == Wide{0})
+        ++p;
+      if (p == n_)
+        return Wide{0};
+
+      if (p != k) {
+        std::swap(perm[k], perm[p]);
+        negate = !negate;
+        stats.add(Counter::Pivots);
+      }
+
+      auto body = [this, k, prev](size_t lo, size_t hi) {
+        eliminateRows(k, prev, lo, hi);
+      };
+      if (pool_)
+        pool_->parallelFor(k + 1, n_, body, 32);
+      else
+        body(k + 1, n_);
+
+      if (overflow_)
+        return std::nullopt;
+      prev = row(k)[k];
+    }
+
+    Wide res = n_ ? row(n_ - 1)[n_ - 1] : Wide{1};
+    return negate ? -res : res;
+  }
+}; // class Bareiss
+
+// Tries 64-bit storage first and falls back to 128-bit one
+template <std::integral T>
+std::optional<Int128> bareissDet(const T *src, size_t n, size_t ld,
+                                 ThreadPool *pool = nullptr) {
+  if (auto res = Bareiss<long long>(src, n, ld, pool).det())
+    return *res;
+  if constexpr (sizeof(Int128) > sizeof(long long))
+    return Bareiss<Int128>(src, n, ld, pool).det();
+  return std::nullopt;
+}
+
+} // namespace mmm
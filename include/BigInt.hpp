@@ -0,0 +1,245 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Sign-magnitude arbitrary precision integer. Only the operations needed to
+// rebuild determinants from modular images are provided.
+class BigInt {
+  using Limb = uint32_t;
+  using Wide = uint64_t;
+  static constexpr int limb_bits = 32;
+
+  bool neg_ = false;
+  std::vector<Limb> mag_; // little-endian, no leading zero limbs
+
+  void trim() {
+    while (!mag_.empty() && mag_.back() == 0)
+      mag_.pop_back();
+    if (mag_.empty())
+      neg_ = false;
+  }
+
+  static std::strong_ordering cmpMag(const std::vector<Limb> &a,
+                                     const std::vector<Limb> &b) noexcept {
+    if (a.size() != b.size())
+      return a.size() <=> b.size();
+    for (size_t i = a.size(); i-- > 0;)
+      if (a[i] != b[i])
+        return a[i] <=> b[i];
+    return std::strong_ordering::equal;
+  }
+
+  // a += b
+  static void addMag(std::vector<Limb> &a, const std::vector<Limb> &b) {
+    a.resize(std::max(a.size(), b.size()) + 1, 0);
+    Wide carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+      Wide cur = carry + a[i] + (i < b.size() ? b[i] : 0);
+      a[i] = static_cast<Limb>(cur);
+      carry = cur >> limb_bits;
+    }
+  }
+
+  // a -= b, requires |a| >= |b|
+  static void subMag(std::vector<Limb> &a, const std::vector<Limb> &b) {
+    Wide borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+      Wide sub = borrow + (i < b.size() ? b[i] : 0);
+      borrow = a[i] < sub;
+      a[i] = static_cast<Limb>(a[i] - sub);
+    }
+  }
+
+public:
+  BigInt() = default;
+
+  template <std::integral T> BigInt(T x) {
+    using U = std::make_unsigned_t<T>;
+    neg_ = x < T{};
+    U mag = neg_ ? U(~static_cast<U>(x) + 1) : static_cast<U>(x);
+    if constexpr (sizeof(U) > sizeof(Limb))
+      for (; mag; mag >>= limb_bits)
+        mag_.push_back(static_cast<Limb>(mag));
+    else if (mag)
+      mag_.push_back(mag);
+  }
+
+#ifdef __SIZEOF_INT128__
+  BigInt(__int128 x) : neg_(x < 0) {
+    auto mag = static_cast<unsigned __int128>(x);
+    if (neg_)
+      mag = ~mag + 1;
+    for (; mag; mag >>= limb_bits)
+      mag_.push_back(static_cast<Limb>(mag));
+  }
+#endif
+
+  [[nodiscard]] bool isZero() const noexcept { return mag_.empty(); }
+  [[nodiscard]] bool isNegative() const noexcept { return neg_; }
+
+  [[nodiscard]] size_t bits() const noexcept {
+    if (mag_.empty())
+      return 0;
+    return mag_.size() * limb_bits - __builtin_clz(mag_.back());
+  }
+
+  BigInt operator-() const {
+    BigInt res = *this;
+    res.neg_ = !res.isZero() && !neg_;
+    return res;
+  }
+
+  // *this = *this * m + a, magnitude only
+  BigInt &mulAdd(Limb m, Limb a) {
+    Wide carry = a;
+    for (auto &limb : mag_) {
+      Wide cur = Wide{limb} * m + carry;
+      limb = static_cast<Limb>(cur);
+      carry = cur >> limb_bits;
+    }
+    if (carry)
+      mag_.push_back(static_cast<Limb>(carry));
+    trim();
+    return *this;
+  }
+
+  BigInt &operator+=(const BigInt &other) {
+    if (neg_ == other.neg_) {
+      addMag(mag_, other.mag_);
+    } else if (cmpMag(mag_, other.mag_) >= 0) {
+      subMag(mag_, other.mag_);
+    } else {
+      auto mag = other.mag_;
+      subMag(mag, mag_);
+      mag_ = std::move(mag);
+      neg_ = other.neg_;
+    }
+    trim();
+    return *this;
+  }
+
+  BigInt &operator-=(const BigInt &other) { return *this += -other; }
+
+  // Schoolbook, products of determinant factors are short
+  BigInt &operator*=(const BigInt &other) {
+    std::vector<Limb> res(mag_.size() + other.mag_.size(), 0);
+    for (size_t i = 0; i < mag_.size(); ++i) {
+      Wide carry = 0;
+      for (size_t j = 0; j < other.mag_.size(); ++j) {
+        Wide cur = Wide{mag_[i]} * other.mag_[j] + res[i + j] + carry;
+        res[i + j] = static_cast<Limb>(cur);
+        carry = cur >> limb_bits;
+      }
+      res[i + other.mag_.size()] = static_cast<Limb>(carry);
+    }
+    mag_ = std::move(res);
+    neg_ = neg_ != other.neg_;
+    trim();
+    return *this;
+  }
+
+  friend BigInt operator+(BigInt lhs, const BigInt &rhs) { return lhs += rhs; }
+  friend BigInt operator-(BigInt lhs, const BigInt &rhs) { return lhs -= rhs; }
+  friend BigInt operator*(BigInt lhs, const BigInt &rhs) { return lhs *= rhs; }
+
+  friend bool operator==(const BigInt &, const BigInt &) = default;
+
+  friend std::strong_ordering operator<=>(const BigInt &lhs,
+                                          const BigInt &rhs) noexcept {
+    if (lhs.neg_ != rhs.neg_)
+      return rhs.neg_ <=> lhs.neg_;
+    auto cmp = cmpMag(lhs.mag_, rhs.mag_);
+    return lhs.neg_ ? 0 <=> cmp : cmp;
+  }
+
+  // Value as T if it is representable
+  template <std::integral T> [[nodiscard]] std::optional<T> narrow() const {
+    using U = std::make_unsigned_t<T>;
+    if (bits() > sizeof(T) * 8)
+      return std::nullopt;
+
+    U mag = 0;
+    if constexpr (sizeof(U) > sizeof(Limb))
+      for (size_t i = mag_.size(); i-- > 0;)
+        mag = (mag << limb_bits) | mag_[i];
+    else if (!mag_.empty())
+      mag = static_cast<U>(mag_[0]);
+
+    if (!neg_) {
+      if (mag > static_cast<U>(std::numeric_limits<T>::max()))
+        return std::nullopt;
+      return static_cast<T>(mag);
+    }
+
+    if constexpr (std::is_unsigned_v<T>)
+      return std::nullopt;
+    else {
+      U lim = static_cast<U>(std::numeric_limits<T>::max()) + 1;
+      if (mag > lim)
+        return std::nullopt;
+      return static_cast<T>(U(~mag + 1));
+    }
+  }
+
+  [[nodiscard]] std::string toString() const {
+    if (isZero())
+      return "0";
+
+    constexpr Limb chunk = 1000000000;
+    std::vector<Limb> mag = mag_;
+    std::vector<Limb> parts;
+    while (!mag.empty()) {
+      Wide rem = 0;
+      for (size_t i = mag.size(); i-- > 0;) {
+        Wide cur = (rem << limb_bits) | mag[i];
+        mag[i] = static_cast<Limb>(cur / chunk);
+        rem = cur % chunk;
+      }
+      parts.push_back(static_cast<Limb>(rem));
+      while (!mag.empty() && mag.back() == 0)
+        mag.pop_back();
+    }
+
+    std::string res = neg_ ? "-" : "";
+    res.append(std::to_string(parts.back()));
+    for (size_t i = parts.size() - 1; i-- > 0;) {
+      auto part = std::to_string(parts[i]);
+      res.append(9 - part.size(), '0').append(part);
+    }
+    return res;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const BigInt &x) {
+    return os << x.toString();
+  }
+}; // class BigInt
+
+} // namespace mmm
@@ -0,0 +1,177 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace mmm { // my magic matrix
+
+// Lazy element-wise expressions. Operators on Slice and FixedVector build
+// lightweight nodes instead of materialized vectors, the whole tree is then
+// evaluated in a single loop when assigned into Slice or FixedVector. Nodes
+// keep plain pointers to operands' data, so they must not outlive them.
+
+// Non-owning strided view of operand data, leaf of every expression
+template <typename T> class StridedLeaf {
+public:
+  using Elem = T;
+
+private:
+  const T *data_;
+  std::ptrdiff_t stride_;
+  size_t n_;
+
+public:
+  constexpr StridedLeaf(const T *data, std::ptrdiff_t stride, size_t n)
+      : data_(data), stride_(stride), n_(n) {}
+
+  [[nodiscard]] constexpr size_t size() const noexcept { return n_; }
+  [[nodiscard]] constexpr bool contiguous() const noexcept {
+    return stride_ == 1;
+  }
+  [[nodiscard]] constexpr const T *data() const noexcept { return data_; }
+
+  constexpr T operator[](size_t i) const noexcept { return data_[i * stride_]; }
+}; // class StridedLeaf
+
+template <typename T> class ScalarLeaf {
+public:
+  using Elem = T;
+
+private:
+  T value_;
+
+public:
+  constexpr ScalarLeaf(const T &value) : value_(value) {}
+
+  [[nodiscard]] constexpr T value() const noexcept { return value_; }
+
+  constexpr T operator[](size_t) const noexcept { return value_; }
+}; // class ScalarLeaf
+
+template <typename E> inline constexpr bool is_scalar_leaf = false;
+template <typename T>
+inline constexpr bool is_scalar_leaf<ScalarLeaf<T>> = true;
+
+template <typename Op, typename L, typename R> class BinaryExpr {
+public:
+  using Elem = typename L::Elem;
+
+private:
+  L lhs_;
+  R rhs_;
+
+public:
+  constexpr BinaryExpr(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+    if constexpr (!is_scalar_leaf<L> && !is_scalar_leaf<R>)
+      if (lhs_.size() != rhs_.size())
+        throw std::runtime_error(
+            "Can't combine expressions with different sizes");
+  }
+
+  [[nodiscard]] constexpr size_t size() const noexcept {
+    if constexpr (is_scalar_leaf<L>)
+      return rhs_.size();
+    else
+      return lhs_.size();
+  }
+
+  [[nodiscard]] constexpr const L &lhs() const noexcept { return lhs_; }
+  [[nodiscard]] constexpr const R &rhs() const noexcept { return rhs_; }
+
+  constexpr Elem operator[](size_t i) const { return Op{}(lhs_[i], rhs_[i]); }
+}; // class BinaryExpr
+
+template <typename E> inline constexpr bool is_expr_node = false;
+template <typename Op, typename L, typename R>
+inline constexpr bool is_expr_node<BinaryExpr<Op, L, R>> = true;
+
+template <typename E>
+concept ExprNode = is_expr_node<std::remove_cvref_t<E>>;
+
+template <ExprNode E> constexpr const E &exprLeaf(const E &e) noexcept {
+  return e;
+}
+
+// Slice and FixedVector provide exprLeaf() overloads found by ADL
+template <typename E>
+concept VecOperand = requires(const E &e) { exprLeaf(e); };
+
+template <VecOperand E>
+using expr_leaf_t = std::remove_cvref_t<decltype(exprLeaf(
+    std::declval<const E &>()))>;
+
+template <VecOperand E> using expr_elem_t = typename expr_leaf_t<E>::Elem;
+
+// Matches lhs -= alpha * x, which maps onto fused fmaSub kernel
+template <typename E> inline constexpr bool is_scaled_leaf = false;
+template <typename T>
+inline constexpr bool is_scaled_leaf<
+    BinaryExpr<std::multiplies<>, ScalarLeaf<T>, StridedLeaf<T>>> = true;
+
+template <typename Op, VecOperand L, VecOperand R>
+constexpr auto makeExpr(const L &lhs, const R &rhs) {
+  using LL = expr_leaf_t<L>;
+  using RL = expr_leaf_t<R>;
+  return BinaryExpr<Op, LL, RL>(exprLeaf(lhs), exprLeaf(rhs));
+}
+
+template <typename Op, VecOperand R>
+constexpr auto makeExpr(const expr_elem_t<R> &lhs, const R &rhs) {
+  using T = expr_elem_t<R>;
+  using RL = expr_leaf_t<R>;
+  return BinaryExpr<Op, ScalarLeaf<T>, RL>(ScalarLeaf<T>(lhs), exprLeaf(rhs));
+}
+
+template <typename Op, VecOperand L>
+constexpr auto makeExpr(const L &lhs, const expr_elem_t<L> &rhs) {
+  using T = expr_elem_t<L>;
+  using LL = expr_leaf_t<L>;
+  return BinaryExpr<Op, LL, ScalarLeaf<T>>(exprLeaf(lhs), ScalarLeaf<T>(rhs));
+}
+
+#define MMM_EXPR_OPERATOR(OP, FUNCTOR)                                         \
+  template <VecOperand L, VecOperand R>                                        \
+    requires std::same_as<expr_elem_t<L>, expr_elem_t<R>>                      \
+  constexpr auto operator OP(const L &lhs, const R &rhs) {                     \
+    return makeExpr<FUNCTOR>(lhs, rhs);                                        \
+  }                                                                            \
+                                                                               \
+  template <VecOperand R>                                                      \
+  constexpr auto operator OP(const expr_elem_t<R> &lhs, const R &rhs) {        \
+    return makeExpr<FUNCTOR>(lhs, rhs);                                        \
+  }                                                                            \
+                                                                               \
+  template <VecOperand L>                                                      \
+  constexpr auto operator OP(const L &lhs, const expr_elem_t<L> &rhs) {        \
+    return makeExpr<FUNCTOR>(lhs, rhs);                                        \
+  }
+
+MMM_EXPR_OPERATOR(+, std::plus<>)
+MMM_EXPR_OPERATOR(-, std::minus<>)
+MMM_EXPR_OPERATOR(*, std::multiplies<>)
+MMM_EXPR_OPERATOR(/, std::divides<>)
+
+#undef MMM_EXPR_OPERATOR
+
+} // namespace mmm
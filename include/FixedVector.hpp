@@ -18,94 +18,140 @@
 
 #pragma once
 
+#include "Allocator.hpp"
+#include "Expr.hpp"
+
 #include <algorithm>
 #include <concepts>
+#include <memory>
 #include <ranges>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace mmm { // my magic matrix
 
-// TODO: if T is not primitive and has heavy ctor, FixedVector ctors with copies
-// to data_ can be unefficient
-template <std::copyable T> class FixedVector {
+// Elements of trivially default constructible T are left uninitialized by
+// FixedVector(size), callers are expected to overwrite them
+template <std::copyable T, typename Alloc = AlignedAllocator<T>>
+class FixedVector {
 public:
   using Elem = T;
   using ElemPtr = T *;
   using Data = ElemPtr;
+  using allocator_type = Alloc;
 
 private:
-  T *data_;
-  size_t size_;
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+  [[no_unique_address]] Alloc alloc_;
+  T *data_ = nullptr;
+  size_t size_ = 0;
+
+  // Allocates n elements and constructs them with init(data), storage is
+  // released if construction throws
+  template <typename F> void init(size_t n, F init) {
+    data_ = n ? AllocTraits::allocate(alloc_, n) : nullptr;
+    size_ = n;
+    try {
+      init(data_);
+    } catch (...) {
+      if (data_)
+        AllocTraits::deallocate(alloc_, data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+      throw;
+    }
+  }
+
+  void defaultConstruct(T *dst) const {
+    if constexpr (!std::is_trivially_default_constructible_v<T>)
+      std::uninitialized_default_construct_n(dst, size_);
+  }
+
+  void release() noexcept {
+    if (!data_)
+      return;
+    std::destroy_n(data_, size_);
+    AllocTraits::deallocate(alloc_, data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
 
 public:
-  constexpr FixedVector(size_t size = 0) : data_(nullptr), size_(size) {
-    data_ = new T[size_];
-    size_ = size;
+  FixedVector(size_t size = 0) {
+    init(size, [this](T *dst) { defaultConstruct(dst); });
   }
 
-  template <std::input_iterator I>
-  FixedVector(I i, size_t n) : data_(nullptr), size_(n) {
-    data_ = new T[size_];
-    std::ranges::copy_n(i, size_, data_);
+  template <std::input_iterator I> FixedVector(I i, size_t n) {
+    init(n, [i, n](T *dst) { std::uninitialized_copy_n(i, n, dst); });
   }
 
-  template <std::ranges::input_range R>
-  FixedVector(R &&r, size_t n) : data_(nullptr), size_(n) {
-    data_ = new T[size_];
-    std::ranges::copy(r | std::views::take(size_), data_);
+  template <std::ranges::input_range R> FixedVector(R &&r, size_t n) {
+    init(n, [this, &r](T *dst) {
+      defaultConstruct(dst);
+      std::ranges::copy(r | std::views::take(size_), dst);
+    });
   }
 
   template <std::random_access_iterator I, std::sentinel_for<I> S>
-  FixedVector(I i, S s) : data_(nullptr), size_(s - i) {
-    data_ = new T[size_];
-    std::ranges::copy(i, s, data_);
+  FixedVector(I i, S s) {
+    init(s - i, [i, s](T *dst) { std::uninitialized_copy(i, s, dst); });
   }
 
-  template <std::ranges::random_access_range R>
-  FixedVector(R &&r) : data_(nullptr), size_(std::ranges::size(r)) {
-    data_ = new T[size_];
-    std::ranges::copy(r | std::views::take(size_), data_);
+  template <std::ranges::random_access_range R> FixedVector(R &&r) {
+    init(std::ranges::size(r), [this, &r](T *dst) {
+      std::uninitialized_copy_n(std::ranges::begin(r), size_, dst);
+    });
   }
 
-  template <std::convertible_to<Elem> U>
-  FixedVector(const FixedVector<U> &other) {
-    size_ = other.size();
-    data_ = new T[size_];
-    std::ranges::copy(other, data_);
+  template <std::convertible_to<Elem> U, typename A>
+  FixedVector(const FixedVector<U, A> &other) {
+    init(other.size(), [&other](T *dst) {
+      std::uninitialized_copy(other.begin(), other.end(), dst);
+    });
   }
 
-  FixedVector(const FixedVector &other) {
-    size_ = other.size();
-    data_ = new T[size_];
-    std::ranges::copy(other, data_);
+  template <ExprNode E> FixedVector(const E &expr) {
+    init(expr.size(), [this, &expr](T *dst) {
+      for (size_t i = 0; i < size_; ++i)
+        std::construct_at(dst + i, expr[i]);
+    });
+  }
+
+  FixedVector(const FixedVector &other)
+      : alloc_(AllocTraits::select_on_container_copy_construction(
+            other.alloc_)) {
+    init(other.size_, [&other](T *dst) {
+      std::uninitialized_copy(other.begin(), other.end(), dst);
+    });
   }
 
   FixedVector &operator=(const FixedVector &other) {
-    size_ = other.size_;
-    delete[] data_;
-    data_ = new T[size_];
-    std::ranges::copy(other, data_);
+    if (this != &other) {
+      FixedVector copy(other);
+      std::swap(data_, copy.data_);
+      std::swap(size_, copy.size_);
+    }
+    return *this;
   }
 
   FixedVector &operator=(FixedVector &&other) noexcept {
-    data_ = other.data_;
-    size_ = other.size_;
-    other.data_ = nullptr;
-    other.size = 0;
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
   }
 
-  FixedVector(FixedVector &&other) noexcept {
-    data_ = other.data_;
-    size_ = other.size_;
-    other.data_ = nullptr;
-    other.size_ = 0;
-  }
+  FixedVector(FixedVector &&other) noexcept
+      : alloc_(std::move(other.alloc_)),
+        data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
 
-  ~FixedVector() noexcept {
-    if (data_)
-      delete[] data_;
-  }
+  ~FixedVector() noexcept { release(); }
 
   [[nodiscard]] size_t size() const noexcept { return size_; }
 
@@ -133,4 +179,9 @@ public:
   }
 }; // class FixedVector
 
+template <typename T, typename A>
+auto exprLeaf(const FixedVector<T, A> &v) noexcept {
+  return StridedLeaf<T>(v.begin(), 1, v.size());
+}
+
 } // namespace mmm
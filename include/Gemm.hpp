@@ -0,0 +1,235 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "FixedVector.hpp"
+#include "Kernels.hpp"
+#include "ScratchPool.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace mmm { // my magic matrix
+
+struct GemmParams {
+  size_t mc = 120;  // rows of A packed at once, block stays in L2
+  size_t kc = 256;  // depth of packed panels, B micro-panel stays in L1
+  size_t nc = 4096; // columns of B packed at once, block stays in L3
+};
+
+// ct = ap * bp for MR x kc micro-panel of A and kc x NR micro-panel of B,
+// ct is MR x NR row-major
+template <typename T>
+using GemmMicroFn = void (*)(size_t kc, const T *ap, const T *bp, T *ct);
+
+template <typename T> struct GemmKernel {
+  size_t mr;
+  size_t nr;
+  GemmMicroFn<T> fn;
+};
+
+// Register-blocked outer products: MR x NR tile of C is kept in MR * 2
+// vector registers of Bytes width. Loops are unrolled by hand, so the tile
+// never spills, and lowered for the target of the calling kernel.
+template <typename T, size_t MR, size_t Bytes>
+[[gnu::always_inline]] inline void gemmMicroBody(size_t kc, const T *ap,
+                                                 const T *bp, T *ct) {
+  typedef T Vec __attribute__((vector_size(Bytes)));
+  constexpr size_t w = Bytes / sizeof(T);
+  constexpr size_t nr = 2 * w;
+
+  Vec acc[MR][2] = {};
+  for (size_t p = 0; p < kc; ++p, ap += MR, bp += nr) {
+    Vec b0, b1;
+    std::memcpy(&b0, bp, sizeof(Vec));
+    std::memcpy(&b1, bp + w, sizeof(Vec));
+#pragma GCC unroll 16
+    for (size_t r = 0; r < MR; ++r) {
+      Vec a = Vec{} + ap[r];
+      acc[r][0] += a * b0;
+      acc[r][1] += a * b1;
+    }
+  }
+
+#pragma GCC unroll 16
+  for (size_t r = 0; r < MR; ++r) {
+    std::memcpy(ct + r * nr, &acc[r][0], sizeof(Vec));
+    std::memcpy(ct + r * nr + w, &acc[r][1], sizeof(Vec));
+  }
+}
+
+template <typename T>
+void gemmMicroGeneric(size_t kc, const T *ap, const T *bp, T *ct) {
+  gemmMicroBody<T, 4, 16>(kc, ap, bp, ct);
+}
+
+#ifdef MMM_X86_KERNELS
+
+template <typename T>
+__attribute__((target("avx2,fma"))) void
+gemmMicroAvx2(size_t kc, const T *ap, const T *bp, T *ct) {
+  gemmMicroBody<T, 6, 32>(kc, ap, bp, ct);
+}
+
+template <typename T>
+__attribute__((target("avx512f,fma"))) void
+gemmMicroAvx512(size_t kc, const T *ap, const T *bp, T *ct) {
+  gemmMicroBody<T, 12, 64>(kc, ap, bp, ct);
+}
+
+#endif // MMM_X86_KERNELS
+
+template <typename T> GemmKernel<T> gemmKernel(KernelIsa isa) noexcept {
+#ifdef MMM_X86_KERNELS
+  switch (isa) {
+  case KernelIsa::Avx512:
+    return {12, 128 / sizeof(T), gemmMicroAvx512<T>};
+  case KernelIsa::Avx2:
+    return {6, 64 / sizeof(T), gemmMicroAvx2<T>};
+  default:
+    break;
+  }
+#endif
+  return {4, 32 / sizeof(T), gemmMicroGeneric<T>};
+}
+
+// C += alpha * A * B, where A is m x k, B is k x n and C is m x n. Operands
+// are given by row accessors returning pointer to the first element of i-th
+// row, so rows may live anywhere, e.g. permuted rows of BlockedLU. B is packed
+// per kc x nc block, A per mc x kc block, into aligned ScratchPool buffers,
+// and the blocks of A are split between pool threads.
+template <typename T, typename ARow, typename BRow, typename CRow>
+void gemm(size_t m, size_t n, size_t k, T alpha, ARow aRow, BRow bRow,
+          CRow cRow, ThreadPool *pool = nullptr, GemmParams params = {}) {
+  static_assert(std::is_arithmetic_v<T>, "GEMM kernels need built-in types");
+  static const GemmKernel<T> kernel = gemmKernel<T>(detectIsa());
+  size_t mr = kernel.mr;
+  size_t nr = kernel.nr;
+  if (m == 0 || n == 0 || k == 0)
+    return;
+
+  size_t mc = std::max(params.mc / mr, size_t{1}) * mr;
+  size_t kc = std::max(params.kc, size_t{1});
+  size_t nc = std::max(params.nc / nr, size_t{1}) * nr;
+  ScratchVector<T> bp(kc * std::min(nc, (n + nr - 1) / nr * nr));
+
+  auto split = [pool](size_t begin, size_t end, auto &&f) {
+    if (pool)
+      pool->parallelFor(begin, end, f);
+    else
+      f(begin, end);
+  };
+
+  for (size_t jc = 0; jc < n; jc += nc) {
+    size_t nb = std::min(nc, n - jc);
+    size_t panels = (nb + nr - 1) / nr;
+    for (size_t pc = 0; pc < k; pc += kc) {
+      size_t kb = std::min(kc, k - pc);
+
+      // B block as nr-column micro-panels, zero padded on the right edge
+      split(0, panels, [&](size_t lo, size_t hi) {
+        for (size_t jr = lo; jr < hi; ++jr) {
+          T *dst = bp.begin() + jr * nr * kb;
+          size_t j0 = jc + jr * nr;
+          size_t cols = std::min(nr, n - j0);
+          for (size_t p = 0; p < kb; ++p, dst += nr) {
+            const T *src = bRow(pc + p) + j0;
+            std::copy_n(src, cols, dst);
+            std::fill(dst + cols, dst + nr, T{});
+          }
+        }
+      });
+
+      size_t blocks = (m + mc - 1) / mc;
+      split(0, blocks, [&](size_t lo, size_t hi) {
+        ScratchVector<T> ap(mc * kb);
+        ScratchVector<T> ct(mr * nr);
+        for (size_t ib = lo; ib < hi; ++ib) {
+          size_t ic = ib * mc;
+          size_t mb = std::min(mc, m - ic);
+
+          // A block as mr-row micro-panels, zero padded at the bottom
+          for (size_t ir = 0; ir < mb; ir += mr) {
+            T *dst = ap.begin() + ir * kb;
+            size_t rows = std::min(mr, mb - ir);
+            for (size_t r = 0; r < mr; ++r) {
+              if (r < rows) {
+                const T *src = aRow(ic + ir + r) + pc;
+                for (size_t p = 0; p < kb; ++p)
+                  dst[p * mr + r] = src[p];
+              } else {
+                for (size_t p = 0; p < kb; ++p)
+                  dst[p * mr + r] = T{};
+              }
+            }
+          }
+
+          for (size_t jr = 0; jr < nb; jr += nr) {
+            size_t cols = std::min(nr, nb - jr);
+            for (size_t ir = 0; ir < mb; ir += mr) {
+              size_t rows = std::min(mr, mb - ir);
+              kernel.fn(kb, ap.begin() + ir * kb, bp.begin() + jr * kb,
+                        ct.begin());
+              for (size_t r = 0; r < rows; ++r) {
+                T *c = cRow(ic + ir + r) + jc + jr;
+                const T *t = ct.begin() + r * nr;
+                for (size_t j = 0; j < cols; ++j)
+                  c[j] += alpha * t[j];
+              }
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+// Row-major dense overload: C += alpha * A * B
+template <typename T>
+void gemm(size_t m, size_t n, size_t k, T alpha, const T *a, size_t lda,
+          const T *b, size_t ldb, T *c, size_t ldc, ThreadPool *pool = nullptr,
+          GemmParams params = {}) {
+  gemm(
+      m, n, k, alpha, [a, lda](size_t i) { return a + i * lda; },
+      [b, ldb](size_t i) { return b + i * ldb; },
+      [c, ldc](size_t i) { return c + i * ldc; }, pool, params);
+}
+
+// y += alpha * A * x for m x n row-major A, rows are split between threads
+template <typename T>
+void gemv(size_t m, size_t n, T alpha, const T *a, size_t lda, const T *x,
+          T *y, ThreadPool *pool = nullptr) {
+  auto body = [=](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      const T *ai = a + i * lda;
+      T sum{};
+      for (size_t j = 0; j < n; ++j)
+        sum += ai[j] * x[j];
+      y[i] += alpha * sum;
+    }
+  };
+  if (pool)
+    pool->parallelFor(0, m, body, 64);
+  else
+    body(0, m);
+}
+
+} // namespace mmm
@@ -0,0 +1,251 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MMM_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace mmm { // my magic matrix
+
+enum class KernelIsa { Scalar, Avx2, Avx512 };
+
+// y[i] -= alpha * x[i] for contiguous y and x
+template <typename T>
+using FmaSubFn = void (*)(T *y, T alpha, const T *x, size_t n);
+
+template <typename T>
+void fmaSubScalar(T *y, T alpha, const T *x, size_t n) noexcept {
+  for (size_t i = 0; i < n; ++i)
+    y[i] -= alpha * x[i];
+}
+
+#ifdef MMM_X86_KERNELS
+
+// Vector kernels use fused multiply-add for the tail too, so every element
+// is rounded the same way regardless of its position in the range.
+
+__attribute__((target("avx2,fma"))) inline void
+fmaSubAvx2(double *y, double alpha, const double *x, size_t n) noexcept {
+  __m256d a = _mm256_set1_pd(alpha);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256d y0 = _mm256_loadu_pd(y + i);
+    __m256d y1 = _mm256_loadu_pd(y + i + 4);
+    y0 = _mm256_fnmadd_pd(a, _mm256_loadu_pd(x + i), y0);
+    y1 = _mm256_fnmadd_pd(a, _mm256_loadu_pd(x + i + 4), y1);
+    _mm256_storeu_pd(y + i, y0);
+    _mm256_storeu_pd(y + i + 4, y1);
+  }
+  for (; i < n; ++i)
+    y[i] = std::fma(-alpha, x[i], y[i]);
+}
+
+__attribute__((target("avx2,fma"))) inline void
+fmaSubAvx2(float *y, float alpha, const float *x, size_t n) noexcept {
+  __m256 a = _mm256_set1_ps(alpha);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256 y0 = _mm256_loadu_ps(y + i);
+    __m256 y1 = _mm256_loadu_ps(y + i + 8);
+    y0 = _mm256_fnmadd_ps(a, _mm256_loadu_ps(x + i), y0);
+    y1 = _mm256_fnmadd_ps(a, _mm256_loadu_ps(x + i + 8), y1);
+    _mm256_storeu_ps(y + i, y0);
+    _mm256_storeu_ps(y + i + 8, y1);
+  }
+  for (; i < n; ++i)
+    y[i] = std::fma(-alpha, x[i], y[i]);
+}
+
+__attribute__((target("avx512f,fma"))) inline void
+fmaSubAvx512(double *y, double alpha, const double *x, size_t n) noexcept {
+  __m512d a = _mm512_set1_pd(alpha);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d y0 = _mm512_loadu_pd(y + i);
+    _mm512_storeu_pd(y + i, _mm512_fnmadd_pd(a, _mm512_loadu_pd(x + i), y0));
+  }
+  if (i < n) {
+    __mmask8 m = static_cast<__mmask8>((1u << (n - i)) - 1);
+    __m512d y0 = _mm512_maskz_loadu_pd(m, y + i);
+    __m512d x0 = _mm512_maskz_loadu_pd(m, x + i);
+    _mm512_mask_storeu_pd(y + i, m, _mm512_fnmadd_pd(a, x0, y0));
+  }
+}
+
+__attribute__((target("avx512f,fma"))) inline void
+fmaSubAvx512(float *y, float alpha, const float *x, size_t n) noexcept {
+  __m512 a = _mm512_set1_ps(alpha);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 y0 = _mm512_loadu_ps(y + i);
+    _mm512_storeu_ps(y + i, _mm512_fnmadd_ps(a, _mm512_loadu_ps(x + i), y0));
+  }
+  if (i < n) {
+    __mmask16 m = static_cast<__mmask16>((1u << (n - i)) - 1);
+    __m512 y0 = _mm512_maskz_loadu_ps(m, y + i);
+    __m512 x0 = _mm512_maskz_loadu_ps(m, x + i);
+    _mm512_mask_storeu_ps(y + i, m, _mm512_fnmadd_ps(a, x0, y0));
+  }
+}
+
+#endif // MMM_X86_KERNELS
+
+inline KernelIsa detectIsa() noexcept {
+#ifdef MMM_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return KernelIsa::Avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return KernelIsa::Avx2;
+#endif
+  return KernelIsa::Scalar;
+}
+
+template <typename T> FmaSubFn<T> fmaSubKernel(KernelIsa isa) noexcept {
+#ifdef MMM_X86_KERNELS
+  if constexpr (std::same_as<T, float> || std::same_as<T, double>) {
+    switch (isa) {
+    case KernelIsa::Avx512:
+      return [](T *y, T alpha, const T *x, size_t n) {
+        fmaSubAvx512(y, alpha, x, n);
+      };
+    case KernelIsa::Avx2:
+      return [](T *y, T alpha, const T *x, size_t n) {
+        fmaSubAvx2(y, alpha, x, n);
+      };
+    default:
+      break;
+    }
+  }
+#endif
+  return fmaSubScalar<T>;
+}
+
+// Dispatches to the widest kernel supported by the running CPU, selected once
+// per element type
+template <typename T> void fmaSub(T *y, T alpha, const T *x, size_t n) {
+  static const FmaSubFn<T> impl = fmaSubKernel<T>(detectIsa());
+  impl(y, alpha, x, n);
+}
+
+template <typename T> struct FloatLayout;
+
+template <> struct FloatLayout<float> {
+  using Bits = uint32_t;
+  static constexpr int mantissa = 23;
+  static constexpr Bits bias = 127;
+};
+
+template <> struct FloatLayout<double> {
+  using Bits = uint64_t;
+  static constexpr int mantissa = 52;
+  static constexpr Bits bias = 1023;
+};
+
+// Sign and log|x[0] * ... * x[n - 1]| by frexp-style accumulation
+template <std::floating_point T>
+std::pair<T, T> signLogProductScalar(const T *x, size_t n) noexcept {
+  T m = 1;
+  long long e = 0;
+  bool negative = false;
+  for (size_t i = 0; i < n; ++i) {
+    if (x[i] == T{0})
+      return {T{0}, -std::numeric_limits<T>::infinity()};
+    negative ^= std::signbit(x[i]);
+    int k;
+    m *= std::frexp(std::abs(x[i]), &k);
+    e += k;
+    m = std::frexp(m, &k);
+    e += k;
+  }
+  return {negative ? T{-1} : T{1},
+          std::log(m) + static_cast<T>(e) * std::numbers::ln2_v<T>};
+}
+
+// Same as signLogProductScalar(), but mantissas are multiplied in independent
+// lanes and renormalized to [1, 2) by bit operations, while exponents are
+// summed as integers, so the loop vectorizes. Product never overflows
+// whatever n is. Zeros, subnormals and non-finite values go to scalar path.
+template <std::floating_point T>
+std::pair<T, T> signLogProduct(const T *x, size_t n) noexcept {
+  if constexpr (requires { typename FloatLayout<T>::Bits; }) {
+    using L = FloatLayout<T>;
+    using Bits = typename L::Bits;
+    constexpr size_t lanes = 64 / sizeof(T);
+    constexpr Bits sign_mask = Bits{1} << (sizeof(Bits) * 8 - 1);
+    constexpr Bits exp_mask = ~sign_mask & ~((Bits{1} << L::mantissa) - 1);
+    constexpr Bits one = L::bias << L::mantissa;
+
+    T acc[lanes];
+    Bits exps[lanes] = {};
+    Bits signs[lanes] = {};
+    Bits bad[lanes] = {};
+    std::fill_n(acc, lanes, T{1});
+
+    size_t body = n - n % lanes;
+    for (size_t i = 0; i < body; i += lanes)
+      for (size_t l = 0; l < lanes; ++l) {
+        Bits b = std::bit_cast<Bits>(x[i + l]);
+        Bits ef = b & exp_mask;
+        signs[l] ^= b & sign_mask;
+        bad[l] |= (ef == 0) | (ef == exp_mask);
+        exps[l] += ef >> L::mantissa;
+        T p = acc[l] * std::bit_cast<T>((b & ~(exp_mask | sign_mask)) | one);
+        Bits pb = std::bit_cast<Bits>(p);
+        exps[l] += (pb >> L::mantissa) - L::bias; // 0 or 1, p is in [1, 4)
+        acc[l] = std::bit_cast<T>((pb & ~exp_mask) | one);
+      }
+
+    Bits anyBad = 0, sign = 0;
+    for (size_t l = 0; l < lanes; ++l) {
+      anyBad |= bad[l];
+      sign ^= signs[l];
+    }
+    if (anyBad)
+      return signLogProductScalar(x, n);
+
+    auto [tailSign, res] = signLogProductScalar(x + body, n - body);
+    if (tailSign == T{0})
+      return {tailSign, res};
+
+    long long e = -static_cast<long long>(L::bias * body);
+    for (size_t l = 0; l < lanes; ++l) {
+      e += static_cast<long long>(exps[l]);
+      res += std::log(acc[l]);
+    }
+    res += static_cast<T>(e) * std::numbers::ln2_v<T>;
+    return {sign ? -tailSign : tailSign, res};
+  } else {
+    return signLogProductScalar(x, n);
+  }
+}
+
+} // namespace mmm
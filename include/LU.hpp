@@ -0,0 +1,220 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "FixedVector.hpp"
+#include "Gemm.hpp"
+#include "Kernels.hpp"
+#include "ScratchPool.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <numeric>
+
+namespace mmm { // my magic matrix
+
+struct LUParams {
+  size_t panel = 64;  // columns factorized per panel
+  size_t grain = 64;  // min columns per thread in row panel solve
+  GemmParams gemm{}; // blocking of trailing update
+};
+
+// Determinant as sign * exp(logAbs): sign is -1, 0 or 1, logAbs is -inf for
+// singular matrices
+template <std::floating_point T> struct SignLogDet {
+  T sign;
+  T logAbs;
+};
+
+// Determinant from reduced precision LU with first order estimate of its
+// relative error. promoted is set if estimate was above tolerance and the
+// determinant was recomputed in double.
+struct MixedDet {
+  double det;
+  double error;
+  bool promoted;
+};
+
+// Right-looking blocked LU with partial pivoting. Works in place on row-major
+// n x n matrix with leading dimension ld. Rows are permuted through perm_
+// instead of physical swaps, so row(i) is i-th row of P * A. If pool is given,
+// trailing updates of each panel step are split between its threads.
+template <std::floating_point T> class BlockedLU {
+public:
+  using Elem = T;
+
+private:
+  T *a_;
+  size_t n_;
+  size_t ld_;
+  LUParams params_;
+  ThreadPool *pool_;
+  ScratchVector<size_t> perm_;
+  size_t swaps_ = 0;
+  bool singular_ = false;
+
+  T *row(size_t i) const noexcept { return a_ + perm_.begin()[i] * ld_; }
+
+  static void axpy(T *y, T alpha, const T *x, size_t n) {
+    fmaSub(y, alpha, x, n);
+  }
+
+  // Unblocked elimination of columns [k0, k0 + kb) over rows [k0, n)
+  void factorPanel(size_t k0, size_t kb) {
+    auto *perm = perm_.begin();
+    for (size_t k = k0; k < k0 + kb; ++k) {
+      size_t p = k;
+      T max = std::abs(row(k)[k]);
+      for (size_t i = k + 1; i < n_; ++i)
+        if (auto cur = std::abs(row(i)[k]); cur > max) {
+          max = cur;
+          p = i;
+        }
+
+      if (max == T{0}) {
+        singular_ = true;
+        return;
+      }
+
+      if (p != k) {
+        std::swap(perm[k], perm[p]);
+        ++swaps_;
+      }
+
+      const T *pk = row(k);
+      T inv = T{1} / pk[k];
+      for (size_t i = k + 1; i < n_; ++i) {
+        T *ri = row(i);
+        T l = ri[k] *= inv;
+        axpy(ri + k + 1, l, pk + k + 1, k0 + kb - k - 1);
+      }
+    }
+  }
+
+  template <typename F> void split(size_t begin, size_t end, F &&f) {
+    if (pool_)
+      pool_->parallelFor(begin, end, f, params_.grain);
+    else
+      f(begin, end);
+  }
+
+  // U12 = L11^-1 * A12, L11 is unit lower triangular. Columns are
+  // independent, so they are split between threads.
+  void solveRowPanel(size_t k0, size_t kb) {
+    size_t j0 = k0 + kb;
+    split(j0, n_, [this, k0, j0](size_t lo, size_t hi) {
+      for (size_t i = k0 + 1; i < j0; ++i) {
+        T *ri = row(i);
+        for (size_t k = k0; k < i; ++k)
+          axpy(ri + lo, ri[k], row(k) + lo, hi - lo);
+      }
+    });
+  }
+
+  // A22 -= L21 * U12 with packed GEMM, which splits rows between threads
+  void updateTrailing(size_t k0, size_t kb) {
+    size_t j0 = k0 + kb;
+    size_t m = n_ - j0;
+    gemm(
+        m, m, kb, T{-1}, [this, j0, k0](size_t i) { return row(j0 + i) + k0; },
+        [this, j0, k0](size_t p) { return row(k0 + p) + j0; },
+        [this, j0](size_t i) { return row(j0 + i) + j0; }, pool_,
+        params_.gemm);
+  }
+
+public:
+  BlockedLU(T *a, size_t n, size_t ld, LUParams params = {},
+            ThreadPool *pool = nullptr)
+      : a_(a), n_(n), ld_(ld), params_(params), pool_(pool), perm_(n) {
+    std::iota(perm_.begin(), perm_.end(), size_t{0});
+  }
+
+  BlockedLU &factorize() {
+    ScopedTimer timer(Phase::Eliminate);
+    size_t nb = std::max<size_t>(params_.panel, 1);
+    for (size_t k0 = 0; k0 < n_; k0 += nb) {
+      size_t kb = std::min(nb, n_ - k0);
+      factorPanel(k0, kb);
+      if (singular_)
+        break;
+
+      if (k0 + kb < n_) {
+        solveRowPanel(k0, kb);
+        updateTrailing(k0, kb);
+      }
+    }
+
+    auto &stats = Stats::global();
+    stats.add(Counter::Determinants);
+    stats.add(Counter::Pivots, swaps_);
+    return *this;
+  }
+
+  [[nodiscard]] bool singular() const noexcept { return singular_; }
+  [[nodiscard]] size_t swaps() const noexcept { return swaps_; }
+  [[nodiscard]] const ScratchVector<size_t> &perm() const noexcept {
+    return perm_;
+  }
+
+  [[nodiscard]] T pivot(size_t i) const noexcept { return row(i)[i]; }
+
+  // Row i of factors: L left of diagonal with implicit unit, U from it on
+  [[nodiscard]] const T *factorRow(size_t i) const noexcept { return row(i); }
+
+  // Largest |U(i, j)|, numerator of growth factor in backward error bound
+  [[nodiscard]] T maxAbsU() const noexcept {
+    T res = 0;
+    for (size_t i = 0; i < n_; ++i) {
+      const T *ri = row(i);
+      for (size_t j = i; j < n_; ++j)
+        res = std::max(res, std::abs(ri[j]));
+    }
+    return res;
+  }
+
+  // Product of pivots accumulated in D, which may be wider than T
+  template <std::floating_point D = T> [[nodiscard]] D detAs() const {
+    if (singular_)
+      return D{0};
+
+    D res = swaps_ % 2 ? D{-1} : D{1};
+    for (size_t i = 0; i < n_; ++i)
+      res *= static_cast<D>(pivot(i));
+    return res;
+  }
+
+  [[nodiscard]] T det() const { return detAs<T>(); }
+
+  // Doesn't overflow or underflow when det() does, see signLogProduct()
+  [[nodiscard]] SignLogDet<T> slogdet() const {
+    if (singular_)
+      return {T{0}, -std::numeric_limits<T>::infinity()};
+
+    ScratchVector<T> pivots(n_);
+    for (size_t i = 0; i < n_; ++i)
+      pivots.begin()[i] = pivot(i);
+    auto [sign, logAbs] = signLogProduct(pivots.begin(), n_);
+    return {swaps_ % 2 ? -sign : sign, logAbs};
+  }
+}; // class BlockedLU
+
+} // namespace mmm
@@ -0,0 +1,110 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "FixedVector.hpp"
+#include "LU.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mmm { // my magic matrix
+
+// Owning LU factorization of a copy of square matrix, converted to floating
+// point T. Factors and pivot permutation are kept, so determinant is O(1),
+// solve is O(n^2) and inverse takes n solves without refactorization.
+template <typename T> class LUFactorization {
+  FixedVector<T> data_;
+  size_t dim_;
+  BlockedLU<T> lu_; // points into data_, so factorization isn't copyable
+
+  void checkRegular() const {
+    if (lu_.singular())
+      throw std::runtime_error("Can't solve system with singular matrix");
+  }
+
+public:
+  template <typename S>
+  LUFactorization(const S *src, size_t n, size_t ld, LUParams params = {},
+                  ThreadPool *pool = nullptr)
+      : data_(n * n), dim_(n), lu_(data_.begin(), n, n, params, pool) {
+    {
+      ScopedTimer timer(Phase::Copy);
+      for (size_t i = 0; i < n; ++i)
+        std::copy_n(src + i * ld, n, data_.begin() + i * n);
+    }
+    lu_.factorize();
+  }
+
+  LUFactorization(const LUFactorization &) = delete;
+  LUFactorization &operator=(const LUFactorization &) = delete;
+
+  size_t dim() const noexcept { return dim_; }
+  bool singular() const noexcept { return lu_.singular(); }
+  const BlockedLU<T> &factors() const noexcept { return lu_; }
+
+  T det() const { return lu_.det(); }
+  SignLogDet<T> slogdet() const { return lu_.slogdet(); }
+
+  // P A = L U, so L y = P b by forward and U x = y by back substitution.
+  // Row i of factors holds L to the left of diagonal and U from it on.
+  FixedVector<T> solve(const FixedVector<T> &b) const {
+    if (b.size() != dim_)
+      throw std::runtime_error("Right hand side size doesn't match matrix");
+    checkRegular();
+
+    FixedVector<T> x(dim_);
+    const auto *perm = lu_.perm().begin();
+    for (size_t i = 0; i < dim_; ++i) {
+      const T *ri = lu_.factorRow(i);
+      T sum = b[perm[i]];
+      for (size_t j = 0; j < i; ++j)
+        sum -= ri[j] * x[j];
+      x[i] = sum;
+    }
+    for (size_t i = dim_; i-- > 0;) {
+      const T *ri = lu_.factorRow(i);
+      T sum = x[i];
+      for (size_t j = i + 1; j < dim_; ++j)
+        sum -= ri[j] * x[j];
+      x[i] = sum / ri[i];
+    }
+    return x;
+  }
+
+  // Row-major inverse, column j solves A x = e_j
+  FixedVector<T> inverse() const {
+    checkRegular();
+    FixedVector<T> res(dim_ * dim_);
+    FixedVector<T> e(dim_);
+    std::fill(e.begin(), e.end(), T{0});
+    for (size_t j = 0; j < dim_; ++j) {
+      e[j] = T{1};
+      auto x = solve(e);
+      e[j] = T{0};
+      for (size_t i = 0; i < dim_; ++i)
+        res[i * dim_ + j] = x[i];
+    }
+    return res;
+  }
+}; // class LUFactorization
+
+} // namespace mmm
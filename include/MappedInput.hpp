@@ -0,0 +1,143 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mmm { // my magic matrix
+
+// Whole contents of a file or file descriptor as one contiguous buffer.
+// Regular files are memory-mapped, pipes and terminals are read in large
+// blocks until end of input. Writable input is mapped copy-on-write, changes
+// never reach the file.
+class MappedInput {
+  static constexpr size_t read_block = size_t{1} << 20;
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  void *map_ = nullptr; // whole file mapping, data_ may start past it
+  size_t mapSize_ = 0;
+  std::string buf_;
+
+  [[noreturn]] static void fail(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  void load(int fd, bool writable) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+      fail("Can't stat input");
+
+    off_t offset = S_ISREG(st.st_mode) ? ::lseek(fd, 0, SEEK_CUR) : -1;
+    if (offset >= 0 && st.st_size > offset) {
+      size_t size = static_cast<size_t>(st.st_size);
+      int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+      void *p = ::mmap(nullptr, size, prot, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+#ifdef __linux__
+        ::madvise(p, size, MADV_SEQUENTIAL);
+#endif
+        map_ = p;
+        mapSize_ = size;
+        data_ = static_cast<const char *>(p) + offset;
+        size_ = size - static_cast<size_t>(offset);
+        return;
+      }
+    }
+
+    for (;;) {
+      size_t used = buf_.size();
+      buf_.resize(used + read_block);
+      ssize_t got = ::read(fd, buf_.data() + used, read_block);
+      if (got < 0 && errno != EINTR)
+        fail("Can't read input");
+      buf_.resize(used + static_cast<size_t>(std::max<ssize_t>(got, 0)));
+      if (got == 0)
+        break;
+    }
+    data_ = buf_.data();
+    size_ = buf_.size();
+  }
+
+public:
+  // Reads from the current position of fd to its end, fd stays open
+  explicit MappedInput(int fd, bool writable = false) { load(fd, writable); }
+
+  explicit MappedInput(const std::string &path, bool writable = false) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      fail("Can't open " + path);
+    try {
+      load(fd, writable);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+
+  MappedInput(const MappedInput &) = delete;
+  MappedInput &operator=(const MappedInput &) = delete;
+
+  MappedInput(MappedInput &&other) noexcept { swap(other); }
+
+  MappedInput &operator=(MappedInput &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~MappedInput() {
+    if (map_)
+      ::munmap(map_, mapSize_);
+  }
+
+  void swap(MappedInput &other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(map_, other.map_);
+    std::swap(mapSize_, other.mapSize_);
+    std::swap(buf_, other.buf_);
+    // Short strings live inside the object and move with it
+    if (!map_)
+      data_ = buf_.data();
+    if (!other.map_)
+      other.data_ = other.buf_.data();
+  }
+
+  [[nodiscard]] bool mapped() const noexcept { return map_ != nullptr; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  // Only meaningful for writable input
+  [[nodiscard]] char *data() noexcept { return const_cast<char *>(data_); }
+
+  [[nodiscard]] std::string_view text() const noexcept {
+    return {data_, size_};
+  }
+}; // class MappedInput
+
+} // namespace mmm
@@ -20,9 +20,14 @@
 
 #include "Concepts.hpp"
 #include "FixedVector.hpp"
+#include "Gemm.hpp"
+#include "LUFactorization.hpp"
+#include "MatrixView.hpp"
 #include "Slice.hpp"
 
 #include <cmath>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <ostream>
 
@@ -32,10 +37,22 @@ template <Arithmetic T> class Matrix {
 public:
   using Elem = T;
   using Data = FixedVector<Elem>;
+  using CompTy = typename MatrixView<T>::CompTy;
+  using Factorization = LUFactorization<CompTy>;
 
 private:
   Data data_;
   size_t dim_;
+  // LU of current elements, see lu(). Dropped by every non-const access.
+  mutable std::shared_ptr<const Factorization> lu_;
+  mutable std::mutex luMutex_;
+
+  void invalidate() noexcept { lu_.reset(); }
+
+  std::shared_ptr<const Factorization> cachedLU() const {
+    std::lock_guard lock(luMutex_);
+    return lu_;
+  }
 
 public:
   constexpr Matrix(size_t n) : data_(n * n), dim_(n) {}
@@ -56,16 +73,26 @@ public:
       throw std::runtime_error("Expected FixedVector with square size");
   }
 
-  Matrix(Data &&data) : data_(std::move(data)), dim_(std::sqrt(data.size())) {
-    if (dim_ * dim_ != data.size())
+  Matrix(Data &&data)
+      : data_(std::move(data)), dim_(std::sqrt(data_.size())) {
+    if (dim_ * dim_ != data_.size())
       throw std::runtime_error("Expected FixedVector with square size");
   }
 
-  Matrix(const Matrix &m) : data_(m.data_), dim_(m.dim_) {}
+  // Materializes view into owned storage
+  explicit Matrix(const MatrixView<T> &view)
+      : data_(view.dim() * view.dim()), dim_(view.dim()) {
+    for (size_t i = 0; i < dim_; ++i)
+      std::copy_n(view.data() + i * view.ld(), dim_, data_.begin() + i * dim_);
+  }
+
+  // Copies share factorization, it is immutable
+  Matrix(const Matrix &m) : data_(m.data_), dim_(m.dim_), lu_(m.cachedLU()) {}
 
   Matrix &operator=(const Matrix &m) {
     data_ = m.data_;
     dim_ = m.dim_;
+    lu_ = m.cachedLU();
     return *this;
   }
 
@@ -80,22 +107,34 @@ public:
           "Trying to copy assign matrix with different dim!");
     data_ = std::move(Data(m));
     dim_ = m.dim();
+    invalidate();
     return *this;
   }
 
-  Matrix(Matrix &&m) : data_(std::move(m.data_)), dim_(m.dim_) {}
+  Matrix(Matrix &&m)
+      : data_(std::move(m.data_)), dim_(m.dim_), lu_(std::move(m.lu_)) {
+    m.dim_ = 0;
+  }
 
   Matrix &operator=(Matrix &&m) {
     data_ = std::move(m.data_);
     dim_ = m.dim_;
+    lu_ = std::move(m.lu_);
     m.dim_ = 0;
     return *this;
   }
 
-  auto *begin() { return data_.begin(); }
+  // Non-const access may write elements, so it drops cached factorization
+  auto *begin() {
+    invalidate();
+    return data_.begin();
+  }
   const auto *begin() const { return data_.begin(); }
 
-  auto *end() { return data_.end(); }
+  auto *end() {
+    invalidate();
+    return data_.end();
+  }
   const auto *end() const { return data_.end(); }
 
   constexpr size_t dim() const { return dim_; }
@@ -104,17 +143,21 @@ public:
     return data_[i * dim_ + j];
   }
 
-  constexpr T &operator()(size_t i, size_t j) { return data_[i * dim_ + j]; }
+  T &operator()(size_t i, size_t j) {
+    invalidate();
+    return data_[i * dim_ + j];
+  }
 
   auto row(size_t i) const {
     return Slice(data_.begin(), dim_ * dim_, dim_ * i, 1, dim_);
   }
 
   Matrix &diagonalize() {
+    invalidate();
     for (auto i : std::views::iota(1u, dim_)) {
       for (auto j : std::views::iota(i, dim_)) {
         T koeff = (*this)(j, i - 1) / (*this)(i - 1, i - 1);
-        row(j) -= koeff * row(i - 1);
+        row(j).fmaSub(koeff, row(i - 1));
       }
     }
     return *this;
@@ -124,20 +167,116 @@ public:
     return Slice(data_.begin(), dim_ * dim_, 0, dim_ + 1, dim_);
   }
 
-  T det() const {
-    using CompTy = typename std::conditional_t<std::integral<T>, double, T>;
+  // Packed blocked GEMM, see gemm()
+  Matrix mul(const Matrix &rhs, ThreadPool *pool = nullptr,
+             GemmParams params = {}) const requires std::is_arithmetic_v<T> {
+    if (dim_ != rhs.dim_)
+      throw std::runtime_error("Can't multiply matrices with different dims");
+
+    Matrix res(dim_);
+    std::fill(res.begin(), res.end(), T{});
+    gemm(dim_, dim_, dim_, T{1}, begin(), dim_, rhs.begin(), dim_, res.begin(),
+         dim_, pool, params);
+    return res;
+  }
+
+  Data mul(const Data &x, ThreadPool *pool = nullptr) const
+      requires std::is_arithmetic_v<T> {
+    if (dim_ != x.size())
+      throw std::runtime_error(
+          "Can't multiply matrix and vector with different sizes");
 
-    switch (dim_) {
-    case 1:
-      return data_[0];
-    case 2:
-      return data_[0] * data_[3] - data_[1] * data_[2];
-    default:
-      Matrix<CompTy> mtx4det(*this);
-      mtx4det.diagonalize();
-      auto tr = mtx4det.trace();
-      return std::reduce(tr.begin(), tr.end(), Elem{1}, std::multiplies{});
+    Data res(dim_);
+    std::fill(res.begin(), res.end(), T{});
+    gemv(dim_, dim_, T{1}, begin(), dim_, x.begin(), res.begin(), pool);
+    return res;
+  }
+
+  MatrixView<T> view() const { return MatrixView<T>(data_.begin(), dim_); }
+
+  // LU factorization of current elements in CompTy, computed by the first
+  // call and shared by later ones until a non-const access to the matrix.
+  // Writes through view(), row() or trace() aren't tracked, and policy of
+  // the call which computed factorization wins.
+  std::shared_ptr<const Factorization> lu(const DetPolicy &policy = {}) const
+      requires std::is_arithmetic_v<T> {
+    std::lock_guard lock(luMutex_);
+    if (!lu_) {
+      std::unique_ptr<ThreadPool> own;
+      auto *pool = view().detPool(policy, own);
+      lu_ = std::make_shared<const Factorization>(data_.begin(), dim_, dim_,
+                                                  policy.blocking, pool);
     }
+    return lu_;
+  }
+
+  // Solution of A x = b and inverse of A by cached factorization, throw
+  // std::runtime_error for singular matrix
+  FixedVector<CompTy> solve(const FixedVector<CompTy> &b,
+                            const DetPolicy &policy = {}) const
+      requires std::is_arithmetic_v<T> {
+    return lu(policy)->solve(b);
+  }
+
+  Matrix<CompTy> inverse(const DetPolicy &policy = {}) const
+      requires std::is_arithmetic_v<T> {
+    return Matrix<CompTy>(lu(policy)->inverse());
+  }
+
+  // Exact for integral T, throws std::overflow_error if determinant doesn't
+  // fit into T, see MatrixView::detBig(). Floating matrices reuse cached
+  // factorization, unless they go to static or structured engines.
+  T det(const DetPolicy &policy = {}) const & {
+    if constexpr (std::floating_point<T>)
+      if (dim_ > max_static_dim && policy.structure == StructureScan::Off)
+        return lu(policy)->det();
+    return view().det(policy);
+  }
+
+  BigInt detBig(const DetPolicy &policy = {}) const &
+      requires std::integral<T> {
+    return view().detBig(policy);
+  }
+
+  // Matrix isn't needed afterwards, so it is factorized in its own storage
+  T det(const DetPolicy &policy = {}) && { return detInplace(policy); }
+
+  BigInt detBig(const DetPolicy &policy = {}) &&
+      requires std::integral<T> {
+    return detBigInplace(policy);
+  }
+
+  // Leaves elements unspecified, see MatrixView::detInplace()
+  T detInplace(const DetPolicy &policy = {}) {
+    invalidate();
+    return view().detInplace(policy);
+  }
+
+  BigInt detBigInplace(const DetPolicy &policy = {})
+      requires std::integral<T> {
+    invalidate();
+    return view().detBigInplace(policy);
+  }
+
+  // Float factorization with error estimate, see MatrixView::detMixed()
+  MixedDet detMixed(const DetPolicy &policy = {},
+                    double tolerance = 1e-4) const {
+    return view().detMixed(policy, tolerance);
+  }
+
+  // Sign and log of |det|, see MatrixView::slogdet()
+  auto slogdet(const DetPolicy &policy = {}) const & {
+    return lu(policy)->slogdet();
+  }
+
+  auto slogdet(const DetPolicy &policy = {}) && {
+    return slogdetInplace(policy);
+  }
+
+  auto slogdetInplace(const DetPolicy &policy = {}) {
+    if (auto cached = cachedLU())
+      return cached->slogdet();
+    return view().slogdetInplace(policy);
   }
 
   void dump(std::ostream &os) {
@@ -149,4 +288,16 @@ public:
   }
 };
 
+// Templates rather than hidden friends, so scalars aren't converted to
+// Matrix through its size constructor
+template <Arithmetic T>
+Matrix<T> operator*(const Matrix<T> &lhs, const Matrix<T> &rhs) {
+  return lhs.mul(rhs);
+}
+
+template <Arithmetic T>
+FixedVector<T> operator*(const Matrix<T> &lhs, const FixedVector<T> &rhs) {
+  return lhs.mul(rhs);
+}
+
 } // namespace mmm
@@ -0,0 +1,211 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "FixedVector.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Wider generic vectors than the target has are lowered element by element
+#if defined(__AVX512F__)
+inline constexpr size_t batch_simd_bytes = 64;
+#elif defined(__AVX__)
+inline constexpr size_t batch_simd_bytes = 32;
+#else
+inline constexpr size_t batch_simd_bytes = 16;
+#endif
+
+// Batch of same-sized square matrices in structure-of-arrays layout: element
+// (i, j) of all matrices is contiguous, so one SIMD lane of elimination
+// handles one matrix.
+template <Arithmetic T> class MatrixBatch {
+public:
+  using Elem = T;
+  using Data = FixedVector<Elem>;
+
+  // Matrices eliminated together, one vector register of the target
+  static constexpr size_t lanes = batch_simd_bytes / sizeof(T);
+
+private:
+  Data data_;
+  size_t count_;
+  size_t dim_;
+
+  size_t index(size_t b, size_t i, size_t j) const noexcept {
+    return (i * dim_ + j) * count_ + b;
+  }
+
+  ThreadPool *batchPool(const DetPolicy &policy,
+                        std::unique_ptr<ThreadPool> &own) const {
+    // Compare total work with the work of one matrix big enough to go parallel
+    size_t work = count_ * dim_ * dim_ * dim_;
+    size_t minWork = policy.minParallelDim * policy.minParallelDim *
+                     policy.minParallelDim;
+    if (work < minWork)
+      return nullptr;
+    if (policy.pool)
+      return policy.pool;
+
+    unsigned threads =
+        policy.threads ? policy.threads : ThreadPool::hardwareThreads();
+    if (threads > 1)
+      own = std::make_unique<ThreadPool>(threads - 1);
+    return own.get();
+  }
+
+  // One register-sized group of lanes, GCC vector extension
+  typedef T Vec __attribute__((vector_size(lanes * sizeof(T))));
+  // Vector attribute is dropped in template arguments, containers hold this
+  struct Lanes {
+    Vec v;
+  };
+
+  // Gaussian elimination with partial pivoting of matrices [b0, b0 + lanes).
+  // Pivot choice differs between lanes, so row swaps and zero pivots are
+  // done with selects instead of branches. Lanes past count_ hold identity.
+  Vec detLanes(size_t b0, Lanes *work) const {
+    Vec *a = &work->v;
+    size_t n = dim_;
+    size_t used = std::min(lanes, count_ - b0);
+    for (size_t e = 0; e < n * n; ++e) {
+      const T *src = data_.begin() + e * count_ + b0;
+      if (used == lanes) {
+        std::memcpy(&a[e], src, sizeof(Vec));
+        continue;
+      }
+      T fill = (e % (n + 1) == 0) ? T{1} : T{0};
+      for (size_t l = 0; l < lanes; ++l)
+        a[e][l] = l < used ? src[l] : fill;
+    }
+
+    auto abs = [](const Vec &x) { return x < 0 ? -x : x; };
+    Vec zero{};
+    Vec res = zero + 1;
+    for (size_t k = 0; k < n; ++k) {
+      Vec *ak = a + k * n;
+      Vec piv = zero + static_cast<T>(k);
+      Vec best = abs(ak[k]);
+      for (size_t i = k + 1; i < n; ++i) {
+        Vec cur = abs(a[i * n + k]);
+        auto more = cur > best;
+        best = more ? cur : best;
+        piv = more ? zero + static_cast<T>(i) : piv;
+      }
+
+      for (size_t i = k + 1; i < n; ++i) {
+        auto swap = piv == static_cast<T>(i);
+        Vec *ai = a + i * n;
+        for (size_t j = k; j < n; ++j) {
+          Vec x = ak[j];
+          Vec y = ai[j];
+          ak[j] = swap ? y : x;
+          ai[j] = swap ? x : y;
+        }
+        res = swap ? -res : res;
+      }
+
+      Vec pivot = ak[k];
+      res *= pivot;
+      auto singular = pivot == 0;
+      Vec inv = (zero + 1) / (singular ? zero + 1 : pivot);
+      inv = singular ? zero : inv;
+      for (size_t i = k + 1; i < n; ++i) {
+        Vec *ai = a + i * n;
+        Vec f = ai[k] * inv;
+        for (size_t j = k + 1; j < n; ++j)
+          ai[j] -= f * ak[j];
+      }
+    }
+    return res;
+  }
+
+public:
+  MatrixBatch(size_t count, size_t dim)
+      : data_(count * dim * dim), count_(count), dim_(dim) {
+    std::fill(data_.begin(), data_.end(), T{});
+  }
+
+  size_t count() const noexcept { return count_; }
+  size_t dim() const noexcept { return dim_; }
+
+  T operator()(size_t b, size_t i, size_t j) const {
+    return data_[index(b, i, j)];
+  }
+
+  T &operator()(size_t b, size_t i, size_t j) { return data_[index(b, i, j)]; }
+
+  void set(size_t b, const Matrix<T> &m) {
+    if (m.dim() != dim_)
+      throw std::runtime_error("Matrix dim doesn't match batch dim");
+    for (size_t i = 0; i < dim_; ++i)
+      for (size_t j = 0; j < dim_; ++j)
+        (*this)(b, i, j) = m(i, j);
+  }
+
+  Matrix<T> matrix(size_t b) const {
+    Matrix<T> m(dim_);
+    for (size_t i = 0; i < dim_; ++i)
+      for (size_t j = 0; j < dim_; ++j)
+        m(i, j) = (*this)(b, i, j);
+    return m;
+  }
+
+  // Determinants of all matrices. Integral batches can't share floating
+  // lanes without losing exactness and go one by one through Matrix::det().
+  Data detBatch(const DetPolicy &policy = {}) const {
+    Data res(count_);
+    if (count_ == 0)
+      return res;
+
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = batchPool(policy, own);
+    auto body = [this, &res](size_t lo, size_t hi) {
+      if constexpr (std::integral<T>) {
+        for (size_t b = lo; b < hi; ++b)
+          res[b] = matrix(b).det();
+      } else {
+        std::vector<Lanes> work(dim_ * dim_);
+        for (size_t b0 = lo * lanes; b0 < std::min(hi * lanes, count_);
+             b0 += lanes) {
+          Vec dets = detLanes(b0, work.data());
+          for (size_t l = 0; l < std::min(lanes, count_ - b0); ++l)
+            res[b0 + l] = dets[l];
+        }
+      }
+    };
+
+    size_t units = std::integral<T> ? count_ : (count_ + lanes - 1) / lanes;
+    size_t grain = std::integral<T> ? 256 : 64;
+    if (pool)
+      pool->parallelFor(0, units, body, grain);
+    else
+      body(0, units);
+    return res;
+  }
+}; // class MatrixBatch
+
+} // namespace mmm
@@ -0,0 +1,377 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "Bareiss.hpp"
+#include "BigInt.hpp"
+#include "Concepts.hpp"
+#include "FixedVector.hpp"
+#include "LU.hpp"
+#include "Modular.hpp"
+#include "ScratchPool.hpp"
+#include "Slice.hpp"
+#include "StaticMatrix.hpp"
+#include "Stats.hpp"
+#include "Structure.hpp"
+#include "ThreadPool.hpp"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Auto scans matrix for triangular, tridiagonal, block-diagonal and banded
+// structure ahead of factorization and routes it to specialised engines.
+// The scan is O(n) for dense matrices, but not free for sparse ones.
+enum class StructureScan { Off, Auto };
+
+struct DetPolicy {
+  LUParams blocking{};
+  unsigned threads = 1;       // 0 means all hardware threads
+  ThreadPool *pool = nullptr; // if set, used instead of spawning threads
+  size_t minParallelDim = 256;
+  StructureScan structure = StructureScan::Off;
+};
+
+// Non-owning square matrix over external memory: element (i, j) lives at
+// data[i * ld + j]. Views are shallow like Slice, constness of the view
+// doesn't protect elements. The whole determinant engine works on views, so
+// Matrix and foreign buffers share it without copying the source.
+template <Arithmetic T> class MatrixView {
+public:
+  using Elem = T;
+  // Floating point type of LU factorization
+  using CompTy = typename std::conditional_t<std::integral<T>, double, T>;
+
+private:
+  T *data_;
+  size_t dim_;
+  size_t ld_;
+
+  // Number of elements between first and last one of the view
+  size_t span() const noexcept { return dim_ ? (dim_ - 1) * ld_ + dim_ : 0; }
+
+  // Copies elements into StaticMatrix<T, dim_> and applies f to it, requires
+  // 0 < dim_ <= max_static_dim
+  template <size_t N = 1, typename F> auto withStatic(F f) const {
+    if constexpr (N < max_static_dim)
+      if (dim_ != N)
+        return withStatic<N + 1>(f);
+
+    ScopedTimer timer(Phase::Eliminate);
+    Stats::global().add(Counter::Determinants);
+    StaticMatrix<T, N> m;
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+        m(i, j) = data_[i * ld_ + j];
+    return f(m);
+  }
+
+  bool isStaticDim() const noexcept {
+    return dim_ != 0 && dim_ <= max_static_dim;
+  }
+
+  // Applies f to LU factorization in floating point. Unless inplace, it runs
+  // on a copy of the elements taken from ScratchPool and reused by the next
+  // call on this thread.
+  template <typename F>
+  auto withLU(const DetPolicy &policy, bool inplace, F f) const {
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = detPool(policy, own);
+    if constexpr (std::same_as<CompTy, T>)
+      if (inplace) {
+        BlockedLU<T> lu(data_, dim_, ld_, policy.blocking, pool);
+        return f(lu.factorize());
+      }
+
+    ScratchVector<CompTy> work(dim_ * dim_);
+    {
+      ScopedTimer timer(Phase::Copy);
+      for (size_t i = 0; i < dim_; ++i)
+        std::copy_n(data_ + i * ld_, dim_, work.begin() + i * dim_);
+    }
+
+    BlockedLU<CompTy> lu(work.begin(), dim_, dim_, policy.blocking, pool);
+    return f(lu.factorize());
+  }
+
+  // LU of elements scaled by 2^-scale and converted to L, so that the
+  // largest one is in [1, 2) and nothing overflows L. Returns growth factor.
+  template <std::floating_point L>
+  L scaledLU(BlockedLU<L> &lu, L *work, int &scale) const {
+    double max = 0;
+    for (size_t i = 0; i < dim_; ++i)
+      for (size_t j = 0; j < dim_; ++j)
+        max = std::max(max, std::abs(static_cast<double>(data_[i * ld_ + j])));
+    std::frexp(max, &scale);
+    scale = max == 0 ? 0 : scale - 1;
+
+    L scaledMax = 0;
+    {
+      ScopedTimer timer(Phase::Copy);
+      for (size_t i = 0; i < dim_; ++i)
+        for (size_t j = 0; j < dim_; ++j) {
+          double x = static_cast<double>(data_[i * ld_ + j]);
+          work[i * dim_ + j] = static_cast<L>(std::ldexp(x, -scale));
+          scaledMax = std::max(scaledMax, std::abs(work[i * dim_ + j]));
+        }
+    }
+
+    lu.factorize();
+    return scaledMax > L{0} ? lu.maxAbsU() / scaledMax : L{1};
+  }
+
+  // Determinant and its first order error estimate n * u * growth
+  template <std::floating_point L>
+  MixedDet detScaled(const DetPolicy &policy) const {
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = detPool(policy, own);
+    ScratchVector<L> work(dim_ * dim_);
+    BlockedLU<L> lu(work.begin(), dim_, dim_, policy.blocking, pool);
+    int scale;
+    L growth = scaledLU(lu, work.begin(), scale);
+    if (lu.singular())
+      return {0, std::numeric_limits<double>::infinity(), false};
+
+    constexpr double u = std::numeric_limits<L>::epsilon() / 2;
+    // One scale per row
+    double det = std::ldexp(lu.template detAs<double>(),
+                            static_cast<int>(dim_) * scale);
+    return {det, static_cast<double>(dim_) * u * growth, false};
+  }
+
+  T detLU(const DetPolicy &policy, bool inplace) const {
+    CompTy res = withLU(policy, inplace, [](auto &lu) { return lu.det(); });
+    if constexpr (std::integral<T>)
+      return static_cast<T>(std::round(res));
+    else
+      return res;
+  }
+
+  // Exact for integral T, so blocks are multiplied as BigInt
+  using StructTy = std::conditional_t<std::integral<T>, BigInt, T>;
+
+  // Independent determinants of diagonal blocks, which are gathered from
+  // rows and columns of each component and split between pool threads
+  StructTy detBlocks(const std::vector<std::vector<size_t>> &blocks,
+                     const DetPolicy &policy) const {
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = detPool(policy, own);
+    DetPolicy inner = policy;
+    inner.threads = 1;
+    inner.pool = nullptr;
+
+    std::vector<StructTy> dets(blocks.size());
+    auto body = [&](size_t lo, size_t hi) {
+      for (size_t b = lo; b < hi; ++b) {
+        const auto &idx = blocks[b];
+        size_t k = idx.size();
+        ScratchVector<T> work(k * k);
+        for (size_t i = 0; i < k; ++i)
+          for (size_t j = 0; j < k; ++j)
+            work.begin()[i * k + j] = data_[idx[i] * ld_ + idx[j]];
+        MatrixView<T> block(work.begin(), k);
+        if constexpr (std::integral<T>)
+          dets[b] = block.detBigInplace(inner);
+        else
+          dets[b] = block.detInplace(inner);
+      }
+    };
+    if (pool)
+      pool->parallelFor(0, blocks.size(), body);
+    else
+      body(0, blocks.size());
+
+    StructTy res(1);
+    for (auto &d : dets)
+      res = res * d;
+    return res;
+  }
+
+  // Determinant by structured engine, nullopt if there is no structure to
+  // exploit. Block-diagonal is found before banded, so that blocks run in
+  // parallel and each one gets its own band.
+  std::optional<StructTy> detStructured(const DetPolicy &policy) const {
+    if (policy.structure == StructureScan::Off || dim_ == 0)
+      return std::nullopt;
+
+    auto band = bandwidths(data_, dim_, ld_);
+    if (band.triangular())
+      return diagonalProduct<StructTy>(data_, dim_, ld_);
+    if (band.tridiagonal())
+      return tridiagonalDet<StructTy>(data_, dim_, ld_);
+    if (auto blocks = components(data_, dim_, ld_, band); !blocks.empty())
+      return detBlocks(blocks, policy);
+    if constexpr (std::floating_point<T>)
+      if (band.banded(dim_))
+        return bandDet(data_, dim_, ld_, band.lower, band.upper);
+    return std::nullopt;
+  }
+
+  T detImpl(const DetPolicy &policy, bool inplace) const {
+    if constexpr (std::integral<T>) {
+      if (isStaticDim())
+        if (auto res = withStatic([](const auto &m) { return m.detWide(); })) {
+          if (!fitsInto<T>(*res))
+            throw std::overflow_error(
+                "Determinant doesn't fit into element type");
+          return static_cast<T>(*res);
+        }
+
+      auto res = detBigImpl(policy, inplace).template narrow<T>();
+      if (!res)
+        throw std::overflow_error("Determinant doesn't fit into element type");
+      return *res;
+    } else if (isStaticDim())
+      return withStatic([](const auto &m) { return m.det(); });
+    else if (auto res = detStructured(policy))
+      return *res;
+    else
+      return detLU(policy, inplace);
+  }
+
+  BigInt detBigImpl(const DetPolicy &policy, bool inplace) const
+      requires std::integral<T> {
+    if (isStaticDim())
+      if (auto res = withStatic([](const auto &m) { return m.detWide(); }))
+        return BigInt(*res);
+    if (auto res = detStructured(policy))
+      return std::move(*res);
+
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = detPool(policy, own);
+    double bound = hadamardLog2(data_, dim_, ld_);
+    // Every minor is below Hadamard bound, so in place elimination can't
+    // overflow T and destroy the elements before giving up
+    if constexpr (std::signed_integral<T>)
+      if (inplace && bound < std::numeric_limits<T>::digits - 1)
+        if (auto res = Bareiss<T>(std::in_place, data_, dim_, ld_, pool).det())
+          return BigInt(*res);
+    if (bound < 62)
+      if (auto res = Bareiss<long long>(data_, dim_, ld_, pool).det())
+        return BigInt(*res);
+    return detModular(data_, dim_, ld_, pool);
+  }
+
+public:
+  constexpr MatrixView(T *data, size_t dim) : MatrixView(data, dim, dim) {}
+
+  constexpr MatrixView(T *data, size_t dim, size_t ld)
+      : data_(data), dim_(dim), ld_(ld) {
+    if (ld_ < dim_)
+      throw std::runtime_error("Leading dimension is less than view dim");
+  }
+
+  constexpr T *data() const noexcept { return data_; }
+  constexpr size_t dim() const noexcept { return dim_; }
+  constexpr size_t ld() const noexcept { return ld_; }
+  constexpr bool contiguous() const noexcept { return ld_ == dim_; }
+
+  // Pool factorization of this view runs on, threads spawned for it are kept
+  // in own. Null for views below policy.minParallelDim.
+  ThreadPool *detPool(const DetPolicy &policy,
+                      std::unique_ptr<ThreadPool> &own) const {
+    if (dim_ < policy.minParallelDim)
+      return nullptr;
+    if (policy.pool)
+      return policy.pool;
+
+    unsigned threads =
+        policy.threads ? policy.threads : ThreadPool::hardwareThreads();
+    if (threads > 1)
+      own = std::make_unique<ThreadPool>(threads - 1);
+    return own.get();
+  }
+
+  constexpr T operator()(size_t i, size_t j) const {
+    return data_[i * ld_ + j];
+  }
+
+  constexpr T &operator()(size_t i, size_t j) { return data_[i * ld_ + j]; }
+
+  // n x n block with top left corner at (i, j), shares memory with *this
+  MatrixView block(size_t i, size_t j, size_t n) const {
+    if (i + n > dim_ || j + n > dim_)
+      throw std::out_of_range("Block is out of view bounds");
+    return MatrixView(data_ + i * ld_ + j, n, ld_);
+  }
+
+  auto row(size_t i) const { return Slice(data_, span(), ld_ * i, 1, dim_); }
+
+  auto trace() const { return Slice(data_, span(), 0, ld_ + 1, dim_); }
+
+  // Exact for integral T, throws std::overflow_error if determinant doesn't
+  // fit into T, see detBig()
+  T det(const DetPolicy &policy = {}) const { return detImpl(policy, false); }
+
+  // Exact determinant of any magnitude. Small matrices go to StaticMatrix
+  // kernels, larger ones to Bareiss elimination when Hadamard bound guarantees
+  // that every minor fits into 64 bits, otherwise multi-modular CRT engine.
+  BigInt detBig(const DetPolicy &policy = {}) const
+      requires std::integral<T> {
+    return detBigImpl(policy, false);
+  }
+
+  // Same as det() and detBig(), but factorize in the viewed memory instead of
+  // a copy when possible and leave elements unspecified
+  T detInplace(const DetPolicy &policy = {}) const {
+    return detImpl(policy, true);
+  }
+
+  BigInt detBigInplace(const DetPolicy &policy = {}) const
+      requires std::integral<T> {
+    return detBigImpl(policy, true);
+  }
+
+  // Opt-in mixed precision: elements are scaled by power of two, stored and
+  // eliminated in float, pivots are multiplied in double. Around twice as
+  // fast as double LU on large matrices. If error estimate exceeds
+  // tolerance, the determinant is recomputed by LU in double.
+  MixedDet detMixed(const DetPolicy &policy = {},
+                    double tolerance = 1e-4) const {
+    if (dim_ == 0)
+      return {1, 0, false};
+
+    auto res = detScaled<float>(policy);
+    if (res.error <= tolerance)
+      return res;
+
+    res = detScaled<double>(policy);
+    res.promoted = true;
+    return res;
+  }
+
+  // Sign and natural log of |det| from floating point LU, finite where det()
+  // of floating T overflows or underflows. Integral matrices are factorized
+  // in double, so their result is approximate.
+  SignLogDet<CompTy> slogdet(const DetPolicy &policy = {}) const {
+    return withLU(policy, false, [](auto &lu) { return lu.slogdet(); });
+  }
+
+  SignLogDet<CompTy> slogdetInplace(const DetPolicy &policy = {}) const {
+    return withLU(policy, true, [](auto &lu) { return lu.slogdet(); });
+  }
+}; // class MatrixView
+
+} // namespace mmm
@@ -0,0 +1,151 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "MappedInput.hpp"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace mmm { // my magic matrix
+
+// Binary matrix file: 64-byte MmxHeader, then dim * dim row-major elements in
+// writer's byte order starting at dataOffset, which is a multiple of align.
+// Readers map it and use the elements in place, so only files of native byte
+// order are accepted.
+enum class MmxKind : uint8_t { Signed = 1, Unsigned = 2, Floating = 3 };
+
+inline constexpr char mmx_magic[4] = {'M', 'M', 'X', '\x1a'};
+inline constexpr uint16_t mmx_version = 1;
+inline constexpr uint32_t mmx_byte_order = 0x01020304;
+inline constexpr uint32_t mmx_align = 64;
+
+struct MmxHeader {
+  char magic[4];
+  uint16_t version;
+  MmxKind kind;
+  uint8_t elemSize;
+  uint32_t byteOrder; // mmx_byte_order as written by the writer
+  uint32_t align;
+  uint64_t dim;
+  uint64_t dataOffset;
+  char reserved[32];
+};
+
+static_assert(sizeof(MmxHeader) == 64 && mmx_align % alignof(MmxHeader) == 0);
+
+template <typename T> constexpr MmxKind mmxKind() noexcept {
+  if constexpr (std::floating_point<T>)
+    return MmxKind::Floating;
+  else if constexpr (std::signed_integral<T>)
+    return MmxKind::Signed;
+  else
+    return MmxKind::Unsigned;
+}
+
+// True if text starts with .mmx magic, text formats never do
+inline bool isMmx(std::string_view text) noexcept {
+  return text.size() >= sizeof(mmx_magic) &&
+         std::memcmp(text.data(), mmx_magic, sizeof(mmx_magic)) == 0;
+}
+
+template <typename T>
+void writeMmx(std::ostream &os, const MatrixView<T> &m)
+    requires std::is_arithmetic_v<T> {
+  MmxHeader header{};
+  std::memcpy(header.magic, mmx_magic, sizeof(mmx_magic));
+  header.version = mmx_version;
+  header.kind = mmxKind<T>();
+  header.elemSize = sizeof(T);
+  header.byteOrder = mmx_byte_order;
+  header.align = mmx_align;
+  header.dim = m.dim();
+  header.dataOffset = sizeof(MmxHeader);
+
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (size_t i = 0; i < m.dim(); ++i)
+    os.write(reinterpret_cast<const char *>(m.data() + i * m.ld()),
+             static_cast<std::streamsize>(m.dim() * sizeof(T)));
+  if (!os)
+    throw std::runtime_error("Can't write mmx matrix");
+}
+
+template <typename T> void writeMmx(std::ostream &os, const Matrix<T> &m) {
+  writeMmx(os, m.view());
+}
+
+// View of .mmx matrix held in memory at data, throws std::runtime_error if
+// the header is invalid or doesn't match T
+template <Arithmetic T> MatrixView<T> mmxView(char *data, size_t size) {
+  MmxHeader h;
+  if (!isMmx(std::string_view(data, size)) || size < sizeof(h))
+    throw std::runtime_error("Not an mmx matrix");
+  std::memcpy(&h, data, sizeof(h));
+
+  if (h.version != mmx_version)
+    throw std::runtime_error(std::string("Unsupported mmx version: ")
+                                 .append(std::to_string(h.version)));
+  if (h.byteOrder != mmx_byte_order)
+    throw std::runtime_error("Mmx matrix has foreign byte order");
+  if (h.kind != mmxKind<T>() || h.elemSize != sizeof(T))
+    throw std::runtime_error("Mmx element type doesn't match matrix type");
+
+  char *elems = data + h.dataOffset;
+  if (h.dataOffset < sizeof(h) || h.dataOffset > size ||
+      reinterpret_cast<uintptr_t>(elems) % alignof(T) != 0)
+    throw std::runtime_error("Invalid mmx data offset");
+  if (h.dim == 0 || (size - h.dataOffset) / sizeof(T) / h.dim < h.dim)
+    throw std::runtime_error("Mmx matrix is truncated");
+
+  return MatrixView<T>(reinterpret_cast<T *>(elems), h.dim);
+}
+
+// Matrix stored in mapped .mmx file. Elements are used where they lie in the
+// mapping, loading costs only page faults. Mapping is private, so the view
+// may be modified, e.g. by MatrixView::detInplace(), without touching the
+// file.
+template <Arithmetic T> class MappedMatrix {
+  MappedInput input_;
+  MatrixView<T> view_;
+
+public:
+  explicit MappedMatrix(MappedInput input)
+      : input_(std::move(input)),
+        view_(mmxView<T>(input_.data(), input_.size())) {}
+
+  explicit MappedMatrix(const std::string &path)
+      : MappedMatrix(MappedInput(path, true)) {}
+
+  MappedMatrix(const MappedMatrix &) = delete;
+  MappedMatrix &operator=(const MappedMatrix &) = delete;
+
+  [[nodiscard]] const MatrixView<T> &view() const noexcept { return view_; }
+  [[nodiscard]] size_t dim() const noexcept { return view_.dim(); }
+  [[nodiscard]] bool mapped() const noexcept { return input_.mapped(); }
+}; // class MappedMatrix
+
+} // namespace mmm
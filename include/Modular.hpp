@@ -0,0 +1,257 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "BigInt.hpp"
+#include "ScratchPool.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Montgomery arithmetic modulo odd p < 2^31 with R = 2^32. Values are kept in
+// Montgomery form in [0, p).
+class Montgomery {
+  uint32_t p_;
+  uint32_t pinv_; // -p^-1 mod 2^32
+  uint32_t r2_;   // R^2 mod p
+
+public:
+  explicit constexpr Montgomery(uint32_t p) : p_(p), pinv_(1), r2_(0) {
+    uint32_t inv = p; // Newton iterations for p^-1 mod 2^32
+    for (int i = 0; i < 4; ++i)
+      inv *= 2 - p * inv;
+    pinv_ = -inv;
+    r2_ = static_cast<uint32_t>((uint64_t{1} << 63) % p * 2 % p);
+  }
+
+  [[nodiscard]] constexpr uint32_t mod() const noexcept { return p_; }
+
+  [[nodiscard]] constexpr uint32_t reduce(uint64_t t) const noexcept {
+    uint32_t m = static_cast<uint32_t>(t) * pinv_;
+    uint32_t res = static_cast<uint32_t>((t + uint64_t{m} * p_) >> 32);
+    return res >= p_ ? res - p_ : res;
+  }
+
+  [[nodiscard]] constexpr uint32_t mul(uint32_t a, uint32_t b) const noexcept {
+    return reduce(uint64_t{a} * b);
+  }
+
+  [[nodiscard]] constexpr uint32_t sub(uint32_t a, uint32_t b) const noexcept {
+    return a >= b ? a - b : a + p_ - b;
+  }
+
+  [[nodiscard]] constexpr uint32_t toMont(uint32_t a) const noexcept {
+    return mul(a % p_, r2_);
+  }
+
+  [[nodiscard]] constexpr uint32_t fromMont(uint32_t a) const noexcept {
+    return reduce(a);
+  }
+
+  template <std::integral T>
+  [[nodiscard]] constexpr uint32_t fromInt(T x) const noexcept {
+    using U = std::make_unsigned_t<T>;
+    uint32_t res;
+    if (x < T{})
+      res = (p_ - static_cast<uint32_t>((U(~static_cast<U>(x)) + 1) % p_)) %
+            p_;
+    else
+      res = static_cast<uint32_t>(static_cast<U>(x) % p_);
+    return toMont(res);
+  }
+
+  [[nodiscard]] constexpr uint32_t pow(uint32_t a, uint32_t e) const noexcept {
+    uint32_t res = toMont(1);
+    for (; e; e >>= 1, a = mul(a, a))
+      if (e & 1)
+        res = mul(res, a);
+    return res;
+  }
+
+  // p is prime, so a^-1 = a^(p - 2)
+  [[nodiscard]] constexpr uint32_t inv(uint32_t a) const noexcept {
+    return pow(a, p_ - 2);
+  }
+}; // class Montgomery
+
+// Deterministic Miller-Rabin for 32-bit numbers
+constexpr bool isPrime32(uint32_t n) noexcept {
+  if (n < 2)
+    return false;
+  for (uint32_t d : {2u, 3u, 5u, 7u, 11u, 13u})
+    if (n % d == 0)
+      return n == d;
+
+  uint32_t d = n - 1;
+  int s = 0;
+  for (; d % 2 == 0; d /= 2)
+    ++s;
+
+  for (uint64_t a : {2u, 7u, 61u}) {
+    if (a % n == 0)
+      continue;
+    uint64_t x = 1;
+    for (uint64_t b = a, e = d; e; e >>= 1, b = b * b % n)
+      if (e & 1)
+        x = x * b % n;
+    if (x == 1 || x == n - 1)
+      continue;
+    bool composite = true;
+    for (int r = 1; r < s && composite; ++r)
+      composite = (x = x * x % n) != n - 1;
+    if (composite)
+      return false;
+  }
+  return true;
+}
+
+// First count primes below 2^31, in descending order
+inline std::vector<uint32_t> modularPrimes(size_t count) {
+  std::vector<uint32_t> primes;
+  primes.reserve(count);
+  for (uint32_t c = (1u << 31) - 1; primes.size() < count; c -= 2)
+    if (isPrime32(c))
+      primes.push_back(c);
+  return primes;
+}
+
+// log2 of Hadamard bound: |det A| <= prod_i ||row_i||_2
+template <std::integral T>
+double hadamardLog2(const T *src, size_t n, size_t ld) noexcept {
+  double res = 0;
+  for (size_t i = 0; i < n; ++i) {
+    long double norm = 0;
+    for (size_t j = 0; j < n; ++j) {
+      long double x = static_cast<long double>(src[i * ld + j]);
+      norm += x * x;
+    }
+    if (norm == 0)
+      return -1;
+    res += 0.5 * std::log2(static_cast<double>(norm));
+  }
+  return res;
+}
+
+// Determinant of matrix modulo prime p, in plain (not Montgomery) form
+template <std::integral T>
+uint32_t detModPrime(const T *src, size_t n, size_t ld, uint32_t p) {
+  Montgomery m(p);
+  ScratchVector<uint32_t> a(n * n);
+  ScratchVector<size_t> perm(n);
+  auto *data = a.begin();
+  auto *rows = perm.begin();
+  std::iota(rows, rows + n, size_t{0});
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      data[i * n + j] = m.fromInt(src[i * ld + j]);
+
+  auto row = [data, rows, n](size_t i) { return data + rows[i] * n; };
+  uint32_t res = m.toMont(1);
+  for (size_t k = 0; k < n; ++k) {
+    size_t piv = k;
+    while (piv < n && row(piv)[k] == 0)
+      ++piv;
+    if (piv == n)
+      return 0;
+    if (piv != k) {
+      std::swap(rows[k], rows[piv]);
+      res = m.sub(0, res);
+    }
+
+    const uint32_t *pk = row(k);
+    res = m.mul(res, pk[k]);
+    uint32_t inv = m.inv(pk[k]);
+    for (size_t i = k + 1; i < n; ++i) {
+      uint32_t *ri = row(i);
+      if (ri[k] == 0)
+        continue;
+      uint32_t f = m.mul(ri[k], inv);
+      for (size_t j = k + 1; j < n; ++j)
+        ri[j] = m.sub(ri[j], m.mul(f, pk[j]));
+    }
+  }
+  return m.fromMont(res);
+}
+
+// Garner's mixed radix reconstruction into symmetric range (-M/2, M/2]
+inline BigInt crtReconstruct(const std::vector<uint32_t> &residues,
+                             const std::vector<uint32_t> &primes) {
+  size_t k = primes.size();
+  std::vector<uint32_t> digits(k);
+  for (size_t i = 0; i < k; ++i) {
+    uint64_t p = primes[i];
+    uint64_t t = residues[i];
+    Montgomery m(primes[i]);
+    for (size_t j = 0; j < i; ++j) {
+      t = (t + p - digits[j] % p) % p;
+      uint32_t inv = m.fromMont(m.inv(m.toMont(primes[j] % primes[i])));
+      t = t * inv % p;
+    }
+    digits[i] = static_cast<uint32_t>(t);
+  }
+
+  BigInt res, modulus(1);
+  for (size_t i = k; i-- > 0;)
+    res.mulAdd(primes[i], digits[i]);
+  for (auto p : primes)
+    modulus.mulAdd(p, 0);
+
+  BigInt twice = res + res;
+  if (twice > modulus)
+    res -= modulus;
+  return res;
+}
+
+// Multi-modular determinant: images modulo enough word-size primes to cover
+// twice the Hadamard bound are computed independently (in parallel if pool is
+// given) and combined with CRT
+template <std::integral T>
+BigInt detModular(const T *src, size_t n, size_t ld,
+                  ThreadPool *pool = nullptr) {
+  ScopedTimer timer(Phase::Eliminate);
+  Stats::global().add(Counter::Determinants);
+  double bound = hadamardLog2(src, n, ld);
+  if (bound < 0)
+    return BigInt(0);
+
+  // Each prime is above 2^30, one more bit for sign and one prime of margin
+  size_t count = static_cast<size_t>(std::ceil((bound + 1) / 30)) + 1;
+  auto primes = modularPrimes(count);
+  std::vector<uint32_t> residues(count);
+
+  auto body = [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i)
+      residues[i] = detModPrime(src, n, ld, primes[i]);
+  };
+  if (pool)
+    pool->parallelFor(0, count, body);
+  else
+    body(0, count);
+
+  return crtReconstruct(residues, primes);
+}
+
+} // namespace mmm
@@ -0,0 +1,173 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mmm { // my magic matrix
+
+// Determinant server wire protocol. Every message is a 16-byte header and
+// length bytes of payload, in native byte order since peers share a host.
+// Request payload is a text matrix (dimension, then elements) or a whole .mmx
+// file. Response payload is the determinant in decimal, exact for integral
+// types and shortest round-trip for floating ones, or an error message.
+// Responses on a connection come in request order, so requests may be
+// pipelined; id is echoed back unchanged.
+enum class WireFormat : uint8_t { Text = 1, Mmx = 2 };
+enum class WireType : uint8_t {
+  Int32 = 1,
+  Int64 = 2,
+  Float32 = 3,
+  Float64 = 4
+};
+enum class WireStatus : uint8_t { Ok = 0, Error = 1 };
+
+inline constexpr uint32_t max_request_bytes = uint32_t{1} << 30;
+
+struct RequestHeader {
+  uint64_t id;
+  uint32_t length;
+  WireFormat format;
+  WireType type;
+  uint16_t reserved;
+};
+
+struct ResponseHeader {
+  uint64_t id;
+  uint32_t length;
+  WireStatus status;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(RequestHeader) == 16 && sizeof(ResponseHeader) == 16);
+
+[[noreturn]] inline void throwErrno(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline void writeAll(int fd, const void *data, size_t size) {
+  auto *p = static_cast<const char *>(data);
+  while (size) {
+    ssize_t done = ::send(fd, p, size, MSG_NOSIGNAL);
+    if (done < 0 && errno == EINTR)
+      continue;
+    if (done < 0)
+      throwErrno("Can't write to socket");
+    p += done;
+    size -= static_cast<size_t>(done);
+  }
+}
+
+// False if peer closed connection before the first byte
+inline bool readAll(int fd, void *data, size_t size) {
+  auto *p = static_cast<char *>(data);
+  for (size_t got = 0; got < size;) {
+    ssize_t done = ::recv(fd, p + got, size - got, 0);
+    if (done < 0 && errno == EINTR)
+      continue;
+    if (done < 0)
+      throwErrno("Can't read from socket");
+    if (done == 0) {
+      if (got == 0)
+        return false;
+      throw std::runtime_error("Connection closed in the middle of message");
+    }
+    got += static_cast<size_t>(done);
+  }
+  return true;
+}
+
+inline sockaddr_un unixAddress(const std::string &path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error("Socket path is too long: " + path);
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+// Blocking client of DetServer. send() and receive() may be interleaved
+// freely to keep several requests in flight.
+class DetClient {
+  int fd_;
+
+public:
+  struct Reply {
+    uint64_t id;
+    bool ok;
+    std::string text; // determinant or error message
+  };
+
+  explicit DetClient(const std::string &path)
+      : fd_(::socket(AF_UNIX, SOCK_STREAM, 0)) {
+    if (fd_ < 0)
+      throwErrno("Can't create socket");
+    auto addr = unixAddress(path);
+    if (::connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+      ::close(fd_);
+      throwErrno("Can't connect to " + path);
+    }
+  }
+
+  DetClient(const DetClient &) = delete;
+  DetClient &operator=(const DetClient &) = delete;
+
+  ~DetClient() { ::close(fd_); }
+
+  void send(uint64_t id, WireFormat format, WireType type,
+            std::string_view payload) {
+    if (payload.size() > max_request_bytes)
+      throw std::runtime_error("Request is too large");
+    RequestHeader h{id, static_cast<uint32_t>(payload.size()), format, type,
+                    0};
+    writeAll(fd_, &h, sizeof(h));
+    writeAll(fd_, payload.data(), payload.size());
+  }
+
+  Reply receive() {
+    ResponseHeader h;
+    if (!readAll(fd_, &h, sizeof(h)))
+      throw std::runtime_error("Server closed connection");
+    Reply res{h.id, h.status == WireStatus::Ok, std::string(h.length, '\0')};
+    readAll(fd_, res.text.data(), h.length);
+    return res;
+  }
+
+  // Round trip of one text request, throws std::runtime_error with server's
+  // message if it fails
+  std::string det(WireType type, std::string_view text) {
+    send(0, WireFormat::Text, type, text);
+    auto reply = receive();
+    if (!reply.ok)
+      throw std::runtime_error(reply.text);
+    return reply.text;
+  }
+}; // class DetClient
+
+} // namespace mmm
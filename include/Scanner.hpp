@@ -19,33 +19,293 @@
 #pragma once
 
 #include "Matrix.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <istream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace mmm { // my magic matrix
 
-template <typename T> [[nodiscard]] Matrix<T> magicScanner(std::istream &is) {
-  auto is_valid = [](std::istream &is) -> bool {
-    return (is.eof() || std::isspace(is.peek())) && !is.fail();
-  };
+// Characters std::isspace accepts in "C" locale
+inline constexpr auto space_table = [] {
+  std::array<bool, 256> res{};
+  for (unsigned char c : std::string_view(" \t\n\v\f\r"))
+    res[c] = true;
+  return res;
+}();
+
+struct ScanPolicy {
+  unsigned threads = 1;       // 0 means all hardware threads
+  ThreadPool *pool = nullptr; // if set, used instead of spawning threads
+  size_t chunkBytes = size_t{4} << 20; // min text per parallel chunk
+};
+
+// Malformed or missing matrix element, element() is its row-major index
+class ScanError : public std::ios_base::failure {
+  size_t element_;
+
+public:
+  explicit ScanError(size_t element)
+      : failure(std::string("Invalid input format at element ")
+                    .append(std::to_string(element))),
+        element_(element) {}
+
+  [[nodiscard]] size_t element() const noexcept { return element_; }
+}; // class ScanError
 
-  int n;
-  is >> n;
-  if (!is_valid(is))
+// Tokenizer over in-memory text with the validation rules of istream
+// extraction: every number has to be followed by whitespace or end of text.
+// Numbers are converted with std::from_chars, locale and stream state are
+// never consulted.
+class TextScanner {
+  const char *cur_;
+  const char *end_;
+
+  static bool isSpace(char c) noexcept {
+    return space_table[static_cast<unsigned char>(c)];
+  }
+
+  static bool isDigit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+  [[noreturn]] static void fail() {
     throw std::ios_base::failure("Invalid input format");
+  }
+
+  // Single separators are the common case, longer runs (alignment padding,
+  // blank lines) are skipped 16 bytes at a time
+  void skipSpace() noexcept {
+    if (cur_ == end_ || !isSpace(*cur_))
+      return;
+
+    typedef signed char Bytes __attribute__((vector_size(16)));
+    while (end_ - cur_ >= 16) {
+      Bytes v;
+      std::memcpy(&v, cur_, sizeof(v));
+      Bytes space = (v == ' ') | ((v >= '\t') & (v <= '\r'));
+      uint64_t half[2];
+      std::memcpy(half, &space, sizeof(half));
+      if (~half[0] | ~half[1])
+        break;
+      cur_ += 16;
+    }
+    while (cur_ != end_ && isSpace(*cur_))
+      ++cur_;
+  }
+
+public:
+  explicit TextScanner(std::string_view text) noexcept
+      : cur_(text.data()), end_(text.data() + text.size()) {}
+
+  // True if only whitespace is left
+  [[nodiscard]] bool atEnd() noexcept {
+    skipSpace();
+    return cur_ == end_;
+  }
+
+  // Text after the last scanned number
+  [[nodiscard]] std::string_view rest() const noexcept {
+    return {cur_, static_cast<size_t>(end_ - cur_)};
+  }
+
+  // Next whitespace separated number into res, false if it is missing,
+  // malformed or out of range of T
+  template <typename T>
+  bool tryNext(T &res) noexcept requires std::is_arithmetic_v<T> {
+    skipSpace();
+    const char *p = cur_;
+    // istream takes explicit plus, from_chars doesn't
+    if (end_ - p > 1 && *p == '+' && p[1] != '-')
+      ++p;
+    // from_chars takes inf and nan, istream doesn't
+    if constexpr (std::floating_point<T>) {
+      const char *d = p != end_ && *p == '-' ? p + 1 : p;
+      if (d == end_ || !(isDigit(*d) || *d == '.'))
+        return false;
+    }
+
+    auto [ptr, ec] = std::from_chars(p, end_, res);
+    if (ec != std::errc{} || (ptr != end_ && !isSpace(*ptr)))
+      return false;
+    cur_ = ptr;
+    return true;
+  }
+
+  // Same as tryNext(), throws std::ios_base::failure instead of false
+  template <typename T> T next() requires std::is_arithmetic_v<T> {
+    T res;
+    if (!tryNext(res))
+      fail();
+    return res;
+  }
+
+  // Number of whitespace separated tokens in the rest of text
+  [[nodiscard]] size_t countTokens() const noexcept {
+    const char *p = cur_;
+    if (p == end_)
+      return 0;
+
+    // Token starts where non-space follows space, 16 positions at a time
+    typedef signed char Bytes __attribute__((vector_size(16)));
+    auto spaces = [](const char *q) {
+      Bytes v;
+      std::memcpy(&v, q, sizeof(v));
+      return (v == ' ') | ((v >= '\t') & (v <= '\r'));
+    };
+    size_t bits = 0;
+    size_t res = !isSpace(*p++);
+    for (; end_ - p >= 16; p += 16) {
+      Bytes starts = ~spaces(p) & spaces(p - 1);
+      uint64_t half[2];
+      std::memcpy(half, &starts, sizeof(half));
+      // Lanes are either 0 or all ones
+      bits += __builtin_popcountll(half[0]) + __builtin_popcountll(half[1]);
+    }
+    res += bits / 8;
+    for (; p != end_; ++p)
+      res += !isSpace(*p) && isSpace(p[-1]);
+    return res;
+  }
+}; // class TextScanner
+
+inline ThreadPool *scanPool(const ScanPolicy &policy, size_t bytes,
+                            std::unique_ptr<ThreadPool> &own) {
+  if (bytes < 2 * policy.chunkBytes)
+    return nullptr;
+  if (policy.pool)
+    return policy.pool;
 
+  unsigned threads =
+      policy.threads ? policy.threads : ThreadPool::hardwareThreads();
+  if (threads > 1)
+    own = std::make_unique<ThreadPool>(threads - 1);
+  return own.get();
+}
+
+// Parses first count tokens of text into dst. Text is cut into chunks at
+// whitespace, chunks count their tokens independently and an exclusive
+// prefix sum of the counts gives every chunk its first element, so chunks
+// are parsed straight into place. Throws ScanError with the smallest bad
+// element index, like sequential scan would.
+template <typename T>
+void scanParallel(std::string_view text, T *dst, size_t count,
+                  ThreadPool &pool, size_t chunkBytes) {
+  size_t chunks = std::max<size_t>(text.size() / chunkBytes, 1);
+  std::vector<size_t> bounds(chunks + 1, text.size());
+  for (size_t c = 0; c < chunks; ++c) {
+    size_t b = text.size() * c / chunks;
+    while (b < text.size() && !space_table[static_cast<uint8_t>(text[b])])
+      ++b;
+    bounds[c] = c ? std::max(b, bounds[c - 1]) : 0;
+  }
+  auto chunk = [&text, &bounds](size_t c) {
+    return TextScanner(text.substr(bounds[c], bounds[c + 1] - bounds[c]));
+  };
+
+  std::vector<size_t> first(chunks + 1, 0);
+  pool.parallelFor(0, chunks, [&first, &chunk](size_t lo, size_t hi) {
+    for (size_t c = lo; c < hi; ++c)
+      first[c + 1] = chunk(c).countTokens();
+  });
+  std::partial_sum(first.begin(), first.end(), first.begin());
+
+  constexpr size_t none = std::numeric_limits<size_t>::max();
+  std::vector<size_t> bad(chunks, none);
+  pool.parallelFor(0, chunks, [&](size_t lo, size_t hi) {
+    for (size_t c = lo; c < hi; ++c) {
+      TextScanner scanner = chunk(c);
+      for (size_t i = first[c]; i < std::min(first[c + 1], count); ++i)
+        if (!scanner.tryNext(dst[i])) {
+          bad[c] = i;
+          break;
+        }
+    }
+  });
+
+  size_t err = *std::min_element(bad.begin(), bad.end());
+  if (first.back() < count)
+    err = std::min(err, first.back());
+  if (err != none)
+    throw ScanError(err);
+}
+
+inline size_t scanDim(TextScanner &scanner) {
+  int n = scanner.next<int>();
   if (n < 1)
     throw std::runtime_error(
         std::string("Invalid matrix size: ").append(std::to_string(n)));
+  return static_cast<size_t>(n);
+}
 
-  Matrix<T> m(n);
-  std::ranges::for_each(m, [&is, is_valid](auto &elem) {
-    is >> elem;
-    if (!is_valid(is))
-      throw std::ios_base::failure("Invalid input format");
-  });
+// Reads dimension and then elements of one square matrix in row-major order
+// and leaves scanner after its last element, so matrices may follow each
+// other in one text
+template <typename T> [[nodiscard]] Matrix<T> scanMatrix(TextScanner &scanner) {
+  ScopedTimer timer(Phase::Parse);
+  size_t left = scanner.rest().size();
+  Matrix<T> m(scanDim(scanner));
+  for (size_t i = 0; i < m.dim() * m.dim(); ++i)
+    if (!scanner.tryNext(m.begin()[i]))
+      throw ScanError(i);
 
+  auto &stats = Stats::global();
+  stats.add(Counter::BytesParsed, left - scanner.rest().size());
+  stats.add(Counter::Elements, m.dim() * m.dim());
+  stats.add(Counter::Matrices);
   return m;
 }
 
+// Reads matrix from the start of text, the rest is ignored. Large texts are
+// parsed in parallel chunks, see scanParallel().
+template <typename T>
+[[nodiscard]] Matrix<T> magicScanner(std::string_view text,
+                                     const ScanPolicy &policy = {}) {
+  TextScanner scanner(text);
+  std::unique_ptr<ThreadPool> own;
+  ThreadPool *pool = scanPool(policy, text.size(), own);
+  if (!pool)
+    return scanMatrix<T>(scanner);
+
+  ScopedTimer timer(Phase::Parse);
+  Matrix<T> m(scanDim(scanner));
+  scanParallel(scanner.rest(), m.begin(), m.dim() * m.dim(), *pool,
+               policy.chunkBytes);
+
+  auto &stats = Stats::global();
+  stats.add(Counter::BytesParsed, text.size());
+  stats.add(Counter::Elements, m.dim() * m.dim());
+  stats.add(Counter::Matrices);
+  return m;
+}
+
+// Reads the rest of the stream in large blocks and parses it as text, the
+// stream is left at its end
+template <typename T>
+[[nodiscard]] Matrix<T> magicScanner(std::istream &is,
+                                     const ScanPolicy &policy = {}) {
+  constexpr size_t block = size_t{1} << 20;
+  std::string text;
+  if (auto *buf = is.rdbuf())
+    for (;;) {
+      size_t used = text.size();
+      text.resize(used + block);
+      auto got = buf->sgetn(text.data() + used, block);
+      text.resize(used + static_cast<size_t>(got));
+      if (got == 0)
+        break;
+    }
+  is.setstate(std::ios_base::eofbit);
+  return magicScanner<T>(std::string_view(text), policy);
+}
+
 } // namespace mmm
@@ -0,0 +1,161 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "Allocator.hpp"
+#include "FixedVector.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+struct ScratchStats {
+  size_t acquires = 0;    // buffers handed out
+  size_t allocations = 0; // of them taken from the system allocator
+  size_t cachedBytes = 0; // held in free lists for reuse
+};
+
+// Per-thread cache of scratch buffers bucketed by power of two size classes,
+// classes of 2 MiB and above are backed by huge pages.
+// Released buffers stay in their class and are handed out again, so code
+// which repeatedly needs the same temporaries stops calling malloc after the
+// first round. Buffers above max_pooled_bytes aren't cached: the work done
+// with them outweighs allocation, and keeping them would pin gigabytes.
+class ScratchPool {
+public:
+  static constexpr size_t min_class_log2 = 6; // one cache line
+  static constexpr size_t max_class_log2 = 26;
+  static constexpr size_t max_pooled_bytes = size_t{1} << max_class_log2;
+
+private:
+  static constexpr size_t classes = max_class_log2 - min_class_log2 + 1;
+
+  std::array<std::vector<std::byte *>, classes> free_;
+  ScratchStats stats_;
+
+  static inline std::atomic<size_t> total_allocations_ = 0;
+
+  static size_t classOf(size_t bytes) noexcept {
+    size_t log2 = std::bit_width(bytes ? bytes - 1 : 0);
+    return (log2 < min_class_log2 ? min_class_log2 : log2) - min_class_log2;
+  }
+
+  static size_t classBytes(size_t cls) noexcept {
+    return size_t{1} << (cls + min_class_log2);
+  }
+
+  ScratchPool() = default;
+
+public:
+  ScratchPool(const ScratchPool &) = delete;
+  ScratchPool &operator=(const ScratchPool &) = delete;
+
+  ~ScratchPool() { trim(); }
+
+  static ScratchPool &local() {
+    thread_local ScratchPool pool;
+    return pool;
+  }
+
+  // Fresh system allocations made by pools of all threads
+  static size_t totalAllocations() noexcept {
+    return total_allocations_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::byte *acquire(size_t bytes) {
+    ++stats_.acquires;
+    if (bytes > max_pooled_bytes) {
+      ++stats_.allocations;
+      total_allocations_.fetch_add(1, std::memory_order_relaxed);
+      return HugePageAllocator<std::byte>().allocate(bytes);
+    }
+
+    size_t cls = classOf(bytes);
+    auto &list = free_[cls];
+    if (!list.empty()) {
+      std::byte *p = list.back();
+      list.pop_back();
+      stats_.cachedBytes -= classBytes(cls);
+      return p;
+    }
+
+    ++stats_.allocations;
+    total_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return HugePageAllocator<std::byte>().allocate(classBytes(cls));
+  }
+
+  void release(std::byte *p, size_t bytes) {
+    if (bytes > max_pooled_bytes)
+      return HugePageAllocator<std::byte>().deallocate(p, bytes);
+
+    size_t cls = classOf(bytes);
+    free_[cls].push_back(p);
+    stats_.cachedBytes += classBytes(cls);
+  }
+
+  // Returns all cached buffers to the system
+  void trim() noexcept {
+    for (size_t cls = 0; cls < classes; ++cls) {
+      for (auto *p : free_[cls])
+        HugePageAllocator<std::byte>().deallocate(p, classBytes(cls));
+      free_[cls].clear();
+    }
+    stats_.cachedBytes = 0;
+  }
+
+  [[nodiscard]] const ScratchStats &stats() const noexcept { return stats_; }
+}; // class ScratchPool
+
+// Allocator over ScratchPool of the calling thread, meant for short-lived
+// temporaries like FixedVector<T, PoolAllocator<T>> workspaces
+template <typename T> class PoolAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = PoolAllocator<U>;
+  };
+
+  constexpr PoolAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    return reinterpret_cast<T *>(ScratchPool::local().acquire(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, size_t n) {
+    ScratchPool::local().release(reinterpret_cast<std::byte *>(p),
+                                 n * sizeof(T));
+  }
+
+  template <typename U>
+  constexpr bool operator==(const PoolAllocator<U> &) const noexcept {
+    return true;
+  }
+}; // class PoolAllocator
+
+template <typename T> using ScratchVector = FixedVector<T, PoolAllocator<T>>;
+
+} // namespace mmm
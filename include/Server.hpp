@@ -0,0 +1,205 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "Allocator.hpp"
+#include "Matrix.hpp"
+#include "Mmx.hpp"
+#include "Protocol.hpp"
+#include "Scanner.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mmm { // my magic matrix
+
+// Long-lived determinant server on a Unix domain socket, see Protocol.hpp.
+// Every connection gets its own thread that answers requests in order, so
+// its receive buffer and thread-local ScratchPool stay warm between requests.
+// Matrices of at least minParallelDim share one pool of worker threads.
+class DetServer {
+  using Buffer = std::vector<char, AlignedAllocator<char>>;
+
+  std::string path_;
+  int listen_ = -1;
+  ThreadPool pool_;
+  DetPolicy policy_;
+
+  std::mutex mtx_;
+  std::condition_variable done_;
+  std::set<int> clients_; // connections being served
+  std::atomic<bool> stop_ = false;
+
+  template <typename T> static std::string toText(const T &det) {
+    if constexpr (std::floating_point<T>) {
+      char buf[64];
+      auto res = std::to_chars(buf, buf + sizeof(buf), det);
+      return std::string(buf, res.ptr);
+    } else {
+      return det.toString();
+    }
+  }
+
+  // Text matrices are parsed into work, which grows but is never freed
+  // while the connection lives
+  template <typename T>
+  std::string detOf(WireFormat format, char *data, size_t size,
+                    Buffer &work) const {
+    auto det = [this](const MatrixView<T> &m) {
+      if constexpr (std::integral<T>)
+        return toText(m.detBigInplace(policy_));
+      else
+        return toText(m.detInplace(policy_));
+    };
+    if (format == WireFormat::Mmx)
+      return det(mmxView<T>(data, size));
+
+    TextScanner scanner(std::string_view(data, size));
+    size_t n = scanDim(scanner);
+    if (work.size() < n * n * sizeof(T))
+      work.resize(n * n * sizeof(T));
+    auto *elems = reinterpret_cast<T *>(work.data());
+    for (size_t i = 0; i < n * n; ++i)
+      if (!scanner.tryNext(elems[i]))
+        throw ScanError(i);
+    return det(MatrixView<T>(elems, n));
+  }
+
+  std::string compute(const RequestHeader &h, char *data, Buffer &work) const {
+    if (h.format != WireFormat::Text && h.format != WireFormat::Mmx)
+      throw std::runtime_error("Unknown request format");
+    switch (h.type) {
+    case WireType::Int32:
+      return detOf<int32_t>(h.format, data, h.length, work);
+    case WireType::Int64:
+      return detOf<int64_t>(h.format, data, h.length, work);
+    case WireType::Float32:
+      return detOf<float>(h.format, data, h.length, work);
+    case WireType::Float64:
+      return detOf<double>(h.format, data, h.length, work);
+    }
+    throw std::runtime_error("Unknown element type");
+  }
+
+  void serve(int fd) {
+    Buffer buf, work;
+    try {
+      RequestHeader req;
+      while (readAll(fd, &req, sizeof(req))) {
+        if (req.length > max_request_bytes)
+          throw std::runtime_error("Request is too large");
+        if (buf.size() < req.length)
+          buf.resize(req.length);
+        readAll(fd, buf.data(), req.length);
+
+        ResponseHeader res{req.id, 0, WireStatus::Ok, {}};
+        std::string text;
+        try {
+          text = compute(req, buf.data(), work);
+        } catch (std::exception &e) {
+          res.status = WireStatus::Error;
+          text = e.what();
+        }
+        res.length = static_cast<uint32_t>(text.size());
+        writeAll(fd, &res, sizeof(res));
+        writeAll(fd, text.data(), text.size());
+      }
+    } catch (std::exception &) {
+      // Broken connection or protocol, only this client is dropped
+    }
+
+    std::lock_guard lock(mtx_);
+    clients_.erase(fd);
+    ::close(fd);
+    done_.notify_all();
+  }
+
+public:
+  // Binds socket at path, replacing a stale socket file. Large determinants
+  // use threads workers in total.
+  explicit DetServer(const std::string &path,
+                     unsigned threads = ThreadPool::hardwareThreads())
+      : path_(path), pool_(threads > 1 ? threads - 1 : 0),
+        policy_{.pool = &pool_} {
+    auto addr = unixAddress(path);
+    listen_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_ < 0)
+      throwErrno("Can't create socket");
+    ::unlink(path.c_str());
+    if (::bind(listen_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ||
+        ::listen(listen_, SOMAXCONN)) {
+      ::close(listen_);
+      throwErrno("Can't listen on " + path);
+    }
+  }
+
+  DetServer(const DetServer &) = delete;
+  DetServer &operator=(const DetServer &) = delete;
+
+  ~DetServer() {
+    stop();
+    std::unique_lock lock(mtx_);
+    done_.wait(lock, [this] { return clients_.empty(); });
+    ::close(listen_);
+    ::unlink(path_.c_str());
+  }
+
+  // Accepts connections until stop() is called
+  void run() {
+    while (!stop_) {
+      int fd = ::accept(listen_, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED)
+          continue;
+        if (stop_)
+          break;
+        throwErrno("Can't accept connection");
+      }
+
+      std::lock_guard lock(mtx_);
+      if (stop_) {
+        ::close(fd);
+        break;
+      }
+      clients_.insert(fd);
+      std::thread([this, fd] { serve(fd); }).detach();
+    }
+  }
+
+  // Wakes run() and drops all connections, safe from any thread
+  void stop() {
+    stop_ = true;
+    ::shutdown(listen_, SHUT_RDWR);
+    std::lock_guard lock(mtx_);
+    for (int fd : clients_)
+      ::shutdown(fd, SHUT_RDWR);
+  }
+}; // class DetServer
+
+} // namespace mmm
@@ -19,7 +19,9 @@
 #pragma once
 
 #include "Concepts.hpp"
+#include "Expr.hpp"
 #include "FixedVector.hpp"
+#include "Kernels.hpp"
 
 #include <functional>
 
@@ -41,6 +43,26 @@ protected:
 
   size_t getIdx(size_t i) const noexcept { return start_ + (i % n_) * stride_; }
 
+  // Evaluates expression tree in one pass: elem = f(elem, expr[i])
+  template <ExprNode E, typename F>
+  void assign(size_t n, const E &expr, F f) {
+    T *dst = data_ + start_;
+    if (stride_ == 1)
+      for (size_t i = 0; i < n; ++i)
+        dst[i] = f(dst[i], expr[i]);
+    else
+      for (size_t i = 0; i < n; ++i)
+        dst[i * stride_] = f(dst[i * stride_], expr[i]);
+  }
+
+  template <ExprNode E> void checkSize(const E &expr, const char *op) const {
+    if (expr.size() != n_)
+      throw std::runtime_error(std::string("Can't ")
+                                   .append(op)
+                                   .append(" Slice and expression with "
+                                           "different sizes"));
+  }
+
 public:
   Slice(Data data, size_t data_size, size_t start, size_t stride, size_t n)
       : data_(data), start_(start), stride_(stride), n_(n) {
@@ -54,11 +76,13 @@ public:
   }
 
   template <std::ranges::random_access_range R>
-  Slice(R &&r) : data_(r.begin()), start_(0), stride_(1), n_(r.size()) {}
+  Slice(R &&r)
+      : data_(std::ranges::data(r)), start_(0), stride_(1),
+        n_(std::ranges::size(r)) {}
 
   template <std::ranges::random_access_range R>
   Slice(R &&r, size_t start, size_t stride, size_t n)
-      : data_(r.begin()), start_(start), stride_(stride), n_(n) {
+      : data_(std::ranges::data(r)), start_(start), stride_(stride), n_(n) {
     size_t last_id = start_ + (n_ - 1) * stride_;
     if (n_ == 0)
       throw std::out_of_range("Slice can't be empty");
@@ -68,16 +92,26 @@ public:
           "Slice size is more than size of underlying data");
   }
 
-  Slice &operator=(const Elem &elem) { std::ranges::fill(*this, elem); }
+  Slice &operator=(const Elem &elem) {
+    std::ranges::fill(*this, elem);
+    return *this;
+  }
 
   Slice &operator=(const FixedVector<T> &vec) {
     auto n = std::min(n_, vec.size());
-    std::ranges::copy(vec | std::views::take(n), *this);
+    std::ranges::copy(vec | std::views::take(n), begin());
+    return *this;
   }
 
   Slice &operator=(FixedVector<T> &&vec) {
     auto n = std::min(n_, vec.size());
-    std::ranges::move(vec | std::views::take(n), *this);
+    std::ranges::move(vec | std::views::take(n), begin());
+    return *this;
+  }
+
+  template <ExprNode E> Slice &operator=(const E &expr) {
+    assign(std::min(n_, expr.size()), expr, [](T &, T val) { return val; });
+    return *this;
   }
 
   [[nodiscard]] size_t size() const noexcept { return n_; }
@@ -174,6 +208,55 @@ public:
     std::ranges::for_each(*this, [other](T &elem) { elem /= other; });
     return *this;
   }
+
+  template <ExprNode E> auto &operator+=(const E &expr) {
+    checkSize(expr, "add");
+    assign(n_, expr, std::plus{});
+    return *this;
+  }
+
+  // s -= alpha * contiguous goes to fused kernel
+  template <ExprNode E> auto &operator-=(const E &expr) {
+    checkSize(expr, "sub");
+    if constexpr (is_scaled_leaf<E>)
+      if (stride_ == 1 && expr.rhs().contiguous()) {
+        mmm::fmaSub(data_ + start_, expr.lhs().value(), expr.rhs().data(), n_);
+        return *this;
+      }
+    assign(n_, expr, std::minus{});
+    return *this;
+  }
+
+  template <ExprNode E> auto &operator*=(const E &expr) {
+    checkSize(expr, "mul");
+    assign(n_, expr, std::multiplies{});
+    return *this;
+  }
+
+  template <ExprNode E> auto &operator/=(const E &expr) {
+    checkSize(expr, "div");
+    assign(n_, expr, std::divides{});
+    return *this;
+  }
+
+  [[nodiscard]] auto leaf() const noexcept {
+    return StridedLeaf<T>(data_ + start_, stride_, n_);
+  }
+
+  // *this -= alpha * other in one pass, without temporaries
+  auto &fmaSub(const T &alpha, const Slice &other) {
+    if (other.n_ != n_)
+      throw std::runtime_error(
+          "Can't fma Slice and Slice with different sizes");
+
+    if (stride_ == 1 && other.stride_ == 1)
+      mmm::fmaSub(data_ + start_, alpha, other.data_ + other.start_, n_);
+    else
+      std::ranges::transform(*this, other, begin(), [alpha](T y, T x) {
+        return y - alpha * x;
+      });
+    return *this;
+  }
 }; // class Slice
 
 template <Arithmetic T> class slice_iterator {
@@ -405,32 +488,8 @@ operator+(const typename const_slice_iterator<T>::difference_type n,
   return ret;
 }
 
-template <Arithmetic T> auto operator+(const T &lhs, const Slice<T> &rhs) {
-  FixedVector<T> data(rhs);
-  Slice<T>(data) += lhs;
-  return data;
-}
-
-template <Arithmetic T> auto operator-(const T &lhs, const Slice<T> &rhs) {
-  FixedVector<T> data(rhs.size());
-  Slice<T> lhs_slice(data);
-  lhs_slice = lhs;
-  lhs_slice -= rhs;
-  return data;
-}
-
-template <Arithmetic T> auto operator*(const T &lhs, const Slice<T> &rhs) {
-  FixedVector<T> data(rhs);
-  Slice<T>(data) *= lhs;
-  return data;
-}
-
-template <Arithmetic T> auto operator/(const T &lhs, const Slice<T> &rhs) {
-  FixedVector<T> data(rhs.size());
-  Slice<T> lhs_slice(data);
-  lhs_slice = lhs;
-  lhs_slice /= rhs;
-  return data;
+template <Arithmetic T> auto exprLeaf(const Slice<T> &s) noexcept {
+  return s.leaf();
 }
 
 } // namespace mmm
@@ -0,0 +1,329 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "BigInt.hpp"
+#include "Modular.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Compressed sparse rows of n x n matrix: columns and values of row i are at
+// [rowPtr[i], rowPtr[i + 1])
+template <typename T> struct CsrRef {
+  size_t n;
+  const size_t *rowPtr;
+  const size_t *colIdx;
+  const T *values;
+};
+
+struct SparseSymbolic {
+  std::vector<size_t> order; // elimination order of rows and columns
+  size_t lnz = 0;            // predicted nonzeros of L with diagonal pivots
+};
+
+// Minimum degree ordering of the pattern of A + A^T. Unlike AMD, it works on
+// explicit elimination graph: neighbours of each eliminated vertex become a
+// clique, so degrees are exact and memory is proportional to nnz plus fill.
+// Ties go to the lower index.
+inline SparseSymbolic analyzeSparse(size_t n, const size_t *rowPtr,
+                                    const size_t *colIdx) {
+  std::vector<std::vector<size_t>> adj(n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; ++p)
+      if (size_t j = colIdx[p]; j != i) {
+        adj[i].push_back(j);
+        adj[j].push_back(i);
+      }
+
+  std::set<std::pair<size_t, size_t>> queue; // degree and vertex
+  for (size_t v = 0; v < n; ++v) {
+    std::ranges::sort(adj[v]);
+    adj[v].erase(std::unique(adj[v].begin(), adj[v].end()), adj[v].end());
+    queue.emplace(adj[v].size(), v);
+  }
+
+  SparseSymbolic res;
+  res.order.reserve(n);
+  std::vector<size_t> merged;
+  while (!queue.empty()) {
+    auto [degree, v] = *queue.begin();
+    queue.erase(queue.begin());
+    res.order.push_back(v);
+    res.lnz += degree;
+
+    // Neighbours of v are alive, eliminated vertices leave every list
+    const auto &nv = adj[v];
+    for (size_t u : nv) {
+      auto &nu = adj[u];
+      queue.erase({nu.size(), u});
+      merged.clear();
+      std::ranges::set_union(nu, nv, std::back_inserter(merged));
+      std::erase_if(merged, [u, v](size_t w) { return w == u || w == v; });
+      nu.swap(merged);
+      queue.emplace(nu.size(), u);
+    }
+    std::vector<size_t>().swap(adj[v]);
+  }
+  return res;
+}
+
+// Parity of permutation by its cycles
+inline bool oddPermutation(const std::vector<size_t> &perm) {
+  std::vector<bool> seen(perm.size());
+  bool odd = false;
+  for (size_t i = 0; i < perm.size(); ++i)
+    for (size_t j = i; !seen[j]; j = perm[j]) {
+      seen[j] = true;
+      odd ^= perm[j] != i;
+    }
+  return odd;
+}
+
+// Arithmetic of sparse LU in floating point, pivots are compared by magnitude
+template <std::floating_point V> struct FloatingField {
+  using Value = V;
+
+  template <typename T> Value from(T x) const { return static_cast<V>(x); }
+  double score(Value x) const { return std::abs(static_cast<double>(x)); }
+  Value mulSub(Value acc, Value l, Value x) const { return acc - l * x; }
+  Value inv(Value x) const { return Value{1} / x; }
+  Value mul(Value a, Value b) const { return a * b; }
+};
+
+// Arithmetic modulo prime in Montgomery form, every nonzero is a good pivot
+struct ModularField {
+  using Value = uint32_t;
+  Montgomery m;
+
+  template <typename T> Value from(T x) const { return m.fromInt(x); }
+  double score(Value x) const { return x != 0; }
+  Value mulSub(Value acc, Value l, Value x) const {
+    return m.sub(acc, m.mul(l, x));
+  }
+  Value inv(Value x) const { return m.inv(x); }
+  Value mul(Value a, Value b) const { return m.mul(a, b); }
+};
+
+// Left-looking Gilbert-Peierls LU of B = A^T with threshold partial pivoting,
+// so columns of B are rows of CSR A and det B = det A. Columns are taken in
+// symbolic order, and diagonal of the same index is preferred as pivot while
+// it is within threshold of the largest candidate, which keeps fill close to
+// prediction. Only L is stored, U is needed for its diagonal alone.
+template <typename F> class SparseLU {
+  using Value = typename F::Value;
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  F field_;
+  size_t n_;
+  std::vector<size_t> lp_{0}; // column k of L is [lp_[k], lp_[k + 1])
+  std::vector<size_t> li_;
+  std::vector<Value> lx_;
+  std::vector<size_t> pinv_;   // step at which row became pivot
+  std::vector<size_t> pivRow_; // row chosen at each step
+  std::vector<Value> pivots_;
+  bool singular_ = false;
+
+  // Rows reachable from pattern of column j through columns of L, stored
+  // into xi[top, n) in topological order
+  size_t reach(const size_t *begin, const size_t *end, std::vector<size_t> &xi,
+               std::vector<size_t> &stack, std::vector<size_t> &pos,
+               std::vector<bool> &marked) const {
+    size_t top = n_;
+    for (const size_t *it = begin; it != end; ++it) {
+      if (marked[*it])
+        continue;
+      stack.push_back(*it);
+      while (!stack.empty()) {
+        size_t r = stack.back();
+        size_t k = pinv_[r];
+        if (!marked[r]) {
+          marked[r] = true;
+          pos[r] = k == npos ? 0 : lp_[k];
+        }
+
+        bool done = true;
+        if (k != npos)
+          for (size_t p = pos[r]; p < lp_[k + 1]; ++p)
+            if (!marked[li_[p]]) {
+              pos[r] = p + 1;
+              stack.push_back(li_[p]);
+              done = false;
+              break;
+            }
+        if (done) {
+          stack.pop_back();
+          xi[--top] = r;
+        }
+      }
+    }
+    return top;
+  }
+
+public:
+  // Factorizes whole matrix, stops at the first zero pivot column
+  template <typename T>
+  SparseLU(const CsrRef<T> &a, const SparseSymbolic &symbolic, F field = {},
+           double threshold = 0.1)
+      : field_(field), n_(a.n), pinv_(a.n, npos) {
+    ScopedTimer timer(Phase::Eliminate);
+    Stats::global().add(Counter::Determinants);
+    li_.reserve(symbolic.lnz);
+    lx_.reserve(symbolic.lnz);
+    pivRow_.reserve(n_);
+    pivots_.reserve(n_);
+
+    std::vector<Value> x(n_);
+    std::vector<size_t> xi(n_), stack, pos(n_);
+    std::vector<bool> marked(n_);
+    for (size_t k = 0; k < n_; ++k) {
+      size_t j = symbolic.order[k];
+      const size_t *begin = a.colIdx + a.rowPtr[j];
+      const size_t *end = a.colIdx + a.rowPtr[j + 1];
+      size_t top = reach(begin, end, xi, stack, pos, marked);
+
+      for (size_t p = a.rowPtr[j]; p < a.rowPtr[j + 1]; ++p)
+        x[a.colIdx[p]] = field_.from(a.values[p]);
+
+      // x = L^-1 B(:, j) over reached rows. Unpivoted rows are leaves, so
+      // they are final when visited and best of them is pivot.
+      size_t best = npos;
+      double bestScore = 0;
+      for (size_t t = top; t < n_; ++t) {
+        size_t r = xi[t];
+        size_t c = pinv_[r];
+        if (c == npos) {
+          if (double s = field_.score(x[r]); s > bestScore) {
+            bestScore = s;
+            best = r;
+          }
+          continue;
+        }
+        Value xr = x[r];
+        for (size_t p = lp_[c]; p < lp_[c + 1]; ++p)
+          x[li_[p]] = field_.mulSub(x[li_[p]], lx_[p], xr);
+      }
+
+      if (double s = field_.score(x[j]);
+          pinv_[j] == npos && s > 0 && s >= threshold * bestScore)
+        best = j;
+
+      if (best == npos) {
+        singular_ = true;
+        return;
+      }
+
+      Value pivot = x[best];
+      Value inv = field_.inv(pivot);
+      pinv_[best] = k;
+      pivRow_.push_back(best);
+      pivots_.push_back(pivot);
+      for (size_t t = top; t < n_; ++t) {
+        size_t r = xi[t];
+        if (pinv_[r] == npos && field_.score(x[r]) > 0) {
+          li_.push_back(r);
+          lx_.push_back(field_.mul(x[r], inv));
+        }
+        x[r] = Value{};
+        marked[r] = false;
+      }
+      lp_.push_back(li_.size());
+      if (best != j)
+        Stats::global().add(Counter::Pivots);
+    }
+  }
+
+  [[nodiscard]] bool singular() const noexcept { return singular_; }
+  [[nodiscard]] const std::vector<Value> &pivots() const noexcept {
+    return pivots_;
+  }
+  [[nodiscard]] size_t nnzL() const noexcept { return li_.size(); }
+
+  // Sign of P and Q in P B Q = L U
+  [[nodiscard]] bool oddPermutations(const SparseSymbolic &symbolic) const {
+    return oddPermutation(pivRow_) != oddPermutation(symbolic.order);
+  }
+}; // class SparseLU
+
+// Sign and pivots of floating sparse LU, sign 0 if singular
+template <std::floating_point V, typename T>
+std::pair<V, std::vector<V>> sparsePivots(const CsrRef<T> &a) {
+  auto symbolic = analyzeSparse(a.n, a.rowPtr, a.colIdx);
+  SparseLU<FloatingField<V>> lu(a, symbolic);
+  if (lu.singular())
+    return {V{0}, {}};
+  return {lu.oddPermutations(symbolic) ? V{-1} : V{1}, lu.pivots()};
+}
+
+// Exact determinant of integral sparse matrix from images modulo primes
+// covering twice Hadamard bound, see detModular()
+template <std::integral T>
+BigInt sparseDetModular(const CsrRef<T> &a, ThreadPool *pool = nullptr) {
+  double bound = 0;
+  for (size_t i = 0; i < a.n; ++i) {
+    long double norm = 0;
+    for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; ++p) {
+      long double x = static_cast<long double>(a.values[p]);
+      norm += x * x;
+    }
+    if (norm == 0)
+      return BigInt(0);
+    bound += 0.5 * std::log2(static_cast<double>(norm));
+  }
+
+  auto symbolic = analyzeSparse(a.n, a.rowPtr, a.colIdx);
+  size_t count = static_cast<size_t>(std::ceil((bound + 1) / 30)) + 1;
+  auto primes = modularPrimes(count);
+  std::vector<uint32_t> residues(count);
+  auto body = [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      ModularField field{Montgomery(primes[i])};
+      SparseLU<ModularField> lu(a, symbolic, field);
+      if (lu.singular()) {
+        residues[i] = 0;
+        continue;
+      }
+      uint32_t res = field.m.toMont(1);
+      for (auto p : lu.pivots())
+        res = field.m.mul(res, p);
+      if (lu.oddPermutations(symbolic))
+        res = field.m.sub(0, res);
+      residues[i] = field.m.fromMont(res);
+    }
+  };
+  if (pool)
+    pool->parallelFor(0, count, body);
+  else
+    body(0, count);
+
+  return crtReconstruct(residues, primes);
+}
+
+} // namespace mmm
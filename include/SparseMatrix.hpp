@@ -0,0 +1,183 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "BigInt.hpp"
+#include "Concepts.hpp"
+#include "Kernels.hpp"
+#include "LU.hpp"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "SparseLU.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+template <Arithmetic T> struct Triplet {
+  size_t row;
+  size_t col;
+  T value;
+};
+
+// Square matrix in compressed sparse rows. Columns within a row are sorted
+// and unique, explicit zeros aren't stored. Memory is proportional to nnz,
+// so it holds matrices far beyond the dense layout of Matrix.
+template <Arithmetic T> class SparseMatrix {
+public:
+  using Elem = T;
+
+private:
+  size_t dim_;
+  std::vector<size_t> rowPtr_;
+  std::vector<size_t> colIdx_;
+  std::vector<T> values_;
+
+  CsrRef<T> csr() const noexcept {
+    return {dim_, rowPtr_.data(), colIdx_.data(), values_.data()};
+  }
+
+public:
+  explicit SparseMatrix(size_t n) : dim_(n), rowPtr_(n + 1, 0) {}
+
+  // Duplicates are summed and zero sums dropped. Triplets are bucketed by
+  // row in two passes and sorted within rows.
+  template <std::ranges::forward_range R>
+  SparseMatrix(size_t n, R &&triplets) : SparseMatrix(n) {
+    for (const Triplet<T> &t : triplets) {
+      if (t.row >= n || t.col >= n)
+        throw std::out_of_range("Triplet is out of matrix bounds");
+      ++rowPtr_[t.row + 1];
+    }
+    std::partial_sum(rowPtr_.begin(), rowPtr_.end(), rowPtr_.begin());
+
+    std::vector<std::pair<size_t, T>> entries(rowPtr_.back());
+    std::vector<size_t> next(rowPtr_.begin(), rowPtr_.end() - 1);
+    for (const Triplet<T> &t : triplets)
+      entries[next[t.row]++] = {t.col, t.value};
+
+    colIdx_.reserve(entries.size());
+    values_.reserve(entries.size());
+    size_t begin = 0;
+    for (size_t i = 0; i < n; ++i) {
+      size_t end = rowPtr_[i + 1];
+      std::sort(entries.begin() + begin, entries.begin() + end,
+                [](auto &a, auto &b) { return a.first < b.first; });
+      rowPtr_[i] = colIdx_.size();
+      for (size_t p = begin; p < end;) {
+        size_t col = entries[p].first;
+        T sum{};
+        for (; p < end && entries[p].first == col; ++p)
+          sum += entries[p].second;
+        if (sum != T{0}) {
+          colIdx_.push_back(col);
+          values_.push_back(sum);
+        }
+      }
+      begin = end;
+    }
+    rowPtr_[n] = colIdx_.size();
+  }
+
+  SparseMatrix(size_t n, std::initializer_list<Triplet<T>> triplets)
+      : SparseMatrix(n, std::span(triplets.begin(), triplets.size())) {}
+
+  // Nonzeros of dense view
+  explicit SparseMatrix(const MatrixView<T> &dense)
+      : SparseMatrix(dense.dim()) {
+    for (size_t i = 0; i < dim_; ++i) {
+      for (size_t j = 0; j < dim_; ++j)
+        if (dense(i, j) != T{0}) {
+          colIdx_.push_back(j);
+          values_.push_back(dense(i, j));
+        }
+      rowPtr_[i + 1] = colIdx_.size();
+    }
+  }
+
+  size_t dim() const noexcept { return dim_; }
+  size_t nnz() const noexcept { return values_.size(); }
+
+  const std::vector<size_t> &rowPtr() const noexcept { return rowPtr_; }
+  const std::vector<size_t> &colIdx() const noexcept { return colIdx_; }
+  const std::vector<T> &values() const noexcept { return values_; }
+
+  // Binary search in row i, zero if element isn't stored
+  T operator()(size_t i, size_t j) const {
+    auto begin = colIdx_.begin() + rowPtr_[i];
+    auto end = colIdx_.begin() + rowPtr_[i + 1];
+    auto it = std::lower_bound(begin, end, j);
+    return it != end && *it == j ? values_[it - colIdx_.begin()] : T{0};
+  }
+
+  Matrix<T> toDense() const {
+    Matrix<T> res(dim_);
+    std::fill(res.begin(), res.end(), T{0});
+    for (size_t i = 0; i < dim_; ++i)
+      for (size_t p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p)
+        res(i, colIdx_[p]) = values_[p];
+    return res;
+  }
+
+  // Sparse LU after minimum degree ordering, see SparseLU. Exact for integral
+  // T and throws std::overflow_error if determinant doesn't fit into T.
+  T det(const DetPolicy &policy = {}) const {
+    if constexpr (std::integral<T>) {
+      auto res = detBig(policy).template narrow<T>();
+      if (!res)
+        throw std::overflow_error("Determinant doesn't fit into element type");
+      return *res;
+    } else {
+      auto [sign, pivots] = sparsePivots<T>(csr());
+      for (auto p : pivots)
+        sign *= p;
+      return sign;
+    }
+  }
+
+  // Multi-modular sparse LU, primes are split between pool threads
+  BigInt detBig(const DetPolicy &policy = {}) const requires std::integral<T> {
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool *pool = policy.pool;
+    unsigned threads =
+        policy.threads ? policy.threads : ThreadPool::hardwareThreads();
+    if (!pool && threads > 1)
+      pool = (own = std::make_unique<ThreadPool>(threads - 1)).get();
+    return sparseDetModular(csr(), pool);
+  }
+
+  // Sign and log|det|, finite for any dimension, see signLogProduct()
+  auto slogdet() const {
+    using CompTy = std::conditional_t<std::integral<T>, double, T>;
+    auto [sign, pivots] = sparsePivots<CompTy>(csr());
+    if (sign == CompTy{0})
+      return SignLogDet<CompTy>{0, -std::numeric_limits<CompTy>::infinity()};
+    auto [psign, logAbs] = signLogProduct(pivots.data(), pivots.size());
+    return SignLogDet<CompTy>{sign * psign, logAbs};
+  }
+};
+
+} // namespace mmm
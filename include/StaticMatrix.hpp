@@ -0,0 +1,178 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "Bareiss.hpp"
+#include "Concepts.hpp"
+
+#include <array>
+#include <optional>
+#include <stdexcept>
+
+namespace mmm { // my magic matrix
+
+// Largest dimension Matrix::det() hands over to StaticMatrix kernels
+inline constexpr size_t max_static_dim = 8;
+
+// Square matrix with compile-time dimension and inline storage. det() is
+// constexpr: closed forms up to 4x4, elimination on local copy (small enough
+// to stay in registers) above.
+template <Arithmetic T, size_t N> class StaticMatrix {
+public:
+  using Elem = T;
+  using Data = std::array<T, N * N>;
+
+private:
+  Data data_{};
+
+  constexpr T at(size_t i, size_t j) const { return data_[i * N + j]; }
+
+  static constexpr T abs(T x) { return x < T{0} ? -x : x; }
+
+  constexpr T detClosed() const {
+    if constexpr (N == 1) {
+      return data_[0];
+    } else if constexpr (N == 2) {
+      return at(0, 0) * at(1, 1) - at(0, 1) * at(1, 0);
+    } else if constexpr (N == 3) {
+      return at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1)) -
+             at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0)) +
+             at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+    } else {
+      // Laplace expansion over 2x2 minors of top and bottom row pairs
+      T s0 = at(0, 0) * at(1, 1) - at(1, 0) * at(0, 1);
+      T s1 = at(0, 0) * at(1, 2) - at(1, 0) * at(0, 2);
+      T s2 = at(0, 0) * at(1, 3) - at(1, 0) * at(0, 3);
+      T s3 = at(0, 1) * at(1, 2) - at(1, 1) * at(0, 2);
+      T s4 = at(0, 1) * at(1, 3) - at(1, 1) * at(0, 3);
+      T s5 = at(0, 2) * at(1, 3) - at(1, 2) * at(0, 3);
+      T c5 = at(2, 2) * at(3, 3) - at(3, 2) * at(2, 3);
+      T c4 = at(2, 1) * at(3, 3) - at(3, 1) * at(2, 3);
+      T c3 = at(2, 1) * at(3, 2) - at(3, 1) * at(2, 2);
+      T c2 = at(2, 0) * at(3, 3) - at(3, 0) * at(2, 3);
+      T c1 = at(2, 0) * at(3, 2) - at(3, 0) * at(2, 2);
+      T c0 = at(2, 0) * at(3, 1) - at(3, 0) * at(2, 1);
+      return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+  }
+
+  // Gaussian elimination with partial pivoting, loops have constant trip
+  // counts and get fully unrolled
+  constexpr T detEliminate() const {
+    Data a = data_;
+    T res{1};
+    for (size_t k = 0; k < N; ++k) {
+      size_t p = k;
+      for (size_t i = k + 1; i < N; ++i)
+        if (abs(a[i * N + k]) > abs(a[p * N + k]))
+          p = i;
+      if (a[p * N + k] == T{0})
+        return T{0};
+
+      if (p != k) {
+        for (size_t j = k; j < N; ++j)
+          std::swap(a[k * N + j], a[p * N + j]);
+        res = -res;
+      }
+
+      T pivot = a[k * N + k];
+      res *= pivot;
+      for (size_t i = k + 1; i < N; ++i) {
+        T f = a[i * N + k] / pivot;
+        for (size_t j = k + 1; j < N; ++j)
+          a[i * N + j] -= f * a[k * N + j];
+      }
+    }
+    return res;
+  }
+
+public:
+  constexpr StaticMatrix() = default;
+  constexpr StaticMatrix(const Data &data) : data_(data) {}
+
+  template <std::input_iterator I> constexpr explicit StaticMatrix(I i) {
+    for (auto &elem : data_)
+      elem = *i++;
+  }
+
+  static constexpr size_t dim() noexcept { return N; }
+
+  constexpr auto begin() noexcept { return data_.begin(); }
+  constexpr auto begin() const noexcept { return data_.begin(); }
+  constexpr auto end() noexcept { return data_.end(); }
+  constexpr auto end() const noexcept { return data_.end(); }
+
+  constexpr T operator()(size_t i, size_t j) const { return at(i, j); }
+  constexpr T &operator()(size_t i, size_t j) { return data_[i * N + j]; }
+
+  // Exact fraction-free elimination in 128 bits, std::nullopt on overflow
+  constexpr std::optional<Int128> detWide() const requires std::integral<T> {
+    std::array<Int128, N * N> a{};
+    for (size_t i = 0; i < N * N; ++i)
+      a[i] = data_[i];
+
+    Int128 prev = 1;
+    bool negate = false;
+    for (size_t k = 0; k + 1 < N; ++k) {
+      size_t p = k;
+      while (p < N && a[p * N + k] == 0)
+        ++p;
+      if (p == N)
+        return Int128{0};
+      if (p != k) {
+        for (size_t j = k; j < N; ++j)
+          std::swap(a[k * N + j], a[p * N + j]);
+        negate = !negate;
+      }
+
+      for (size_t i = k + 1; i < N; ++i)
+        for (size_t j = k + 1; j < N; ++j) {
+          Int128 l, r, num;
+          if (__builtin_mul_overflow(a[i * N + j], a[k * N + k], &l) ||
+              __builtin_mul_overflow(a[i * N + k], a[k * N + j], &r) ||
+              __builtin_sub_overflow(l, r, &num))
+            return std::nullopt;
+          a[i * N + j] = num / prev;
+        }
+      prev = a[k * N + k];
+    }
+
+    Int128 res = a[N * N - 1];
+    return negate ? -res : res;
+  }
+
+  // Exact for integral T, throws std::overflow_error if determinant doesn't
+  // fit into T
+  constexpr T det() const {
+    if constexpr (N == 0) {
+      return T{1};
+    } else if constexpr (std::integral<T>) {
+      auto res = detWide();
+      if (!res || !fitsInto<T>(*res))
+        throw std::overflow_error("Determinant doesn't fit into element type");
+      return static_cast<T>(*res);
+    } else if constexpr (N <= 4) {
+      return detClosed();
+    } else {
+      return detEliminate();
+    }
+  }
+}; // class StaticMatrix
+
+} // namespace mmm
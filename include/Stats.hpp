@@ -0,0 +1,181 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "ScratchPool.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace mmm { // my magic matrix
+
+// Phases of determinant computation timed by ScopedTimer. Times are summed
+// over threads, so with parallel engines they may exceed wall time.
+enum class Phase { Parse, Copy, Eliminate, Output };
+
+enum class Counter {
+  BytesParsed,
+  Elements,     // parsed matrix elements
+  Matrices,     // parsed matrices
+  Determinants, // engine runs, fallbacks to wider engines included
+  Pivots,       // row interchanges during elimination
+};
+
+enum class StatsFormat { Text = 1, Json };
+
+// Process wide timers and counters of hot paths. Disabled by default, then
+// every probe costs one relaxed load and a predictable branch. Updates are
+// relaxed atomics, so probes are safe from pool threads.
+class Stats {
+  static constexpr size_t phase_count = 4;
+  static constexpr size_t counter_count = 5;
+  static constexpr std::array<std::string_view, phase_count> phase_names = {
+      "parse", "copy", "eliminate", "output"};
+  static constexpr std::array<std::string_view, counter_count> counter_names =
+      {"bytes_parsed", "elements", "matrices", "determinants", "pivots"};
+
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<bool> enabled_ = false;
+  std::array<std::atomic<uint64_t>, phase_count> nanos_{};
+  std::array<std::atomic<uint64_t>, phase_count> calls_{};
+  std::array<std::atomic<uint64_t>, counter_count> counters_{};
+  Clock::time_point start_{};
+  size_t startAllocations_ = 0;
+
+  static uint64_t load(const std::atomic<uint64_t> &x) noexcept {
+    return x.load(std::memory_order_relaxed);
+  }
+
+public:
+  static Stats &global() noexcept {
+    static Stats stats;
+    return stats;
+  }
+
+  [[nodiscard]] bool enabled() const noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Resets everything and starts wall clock of report
+  void enable() noexcept {
+    reset();
+    enabled_.store(true, std::memory_order_relaxed);
+  }
+
+  void disable() noexcept { enabled_.store(false, std::memory_order_relaxed); }
+
+  void reset() noexcept {
+    for (size_t i = 0; i < phase_count; ++i) {
+      nanos_[i].store(0, std::memory_order_relaxed);
+      calls_[i].store(0, std::memory_order_relaxed);
+    }
+    for (auto &c : counters_)
+      c.store(0, std::memory_order_relaxed);
+    start_ = Clock::now();
+    startAllocations_ = ScratchPool::totalAllocations();
+  }
+
+  void add(Counter c, uint64_t n = 1) noexcept {
+    if (enabled())
+      counters_[static_cast<size_t>(c)].fetch_add(n,
+                                                  std::memory_order_relaxed);
+  }
+
+  void addTime(Phase p, std::chrono::nanoseconds t) noexcept {
+    auto i = static_cast<size_t>(p);
+    nanos_[i].fetch_add(t.count(), std::memory_order_relaxed);
+    calls_[i].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint64_t count(Counter c) const noexcept {
+    return load(counters_[static_cast<size_t>(c)]);
+  }
+
+  [[nodiscard]] uint64_t nanos(Phase p) const noexcept {
+    return load(nanos_[static_cast<size_t>(p)]);
+  }
+
+  [[nodiscard]] uint64_t calls(Phase p) const noexcept {
+    return load(calls_[static_cast<size_t>(p)]);
+  }
+
+  // Fresh scratch buffers taken from the system since enable()
+  [[nodiscard]] size_t allocations() const noexcept {
+    return ScratchPool::totalAllocations() - startAllocations_;
+  }
+
+  void report(std::ostream &os, StatsFormat format = StatsFormat::Text) const {
+    auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start_)
+                    .count();
+    auto ms = [](uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+
+    if (format == StatsFormat::Json) {
+      os << "{\"wall_ns\":" << wall << ",\"phases\":{";
+      for (size_t i = 0; i < phase_count; ++i)
+        os << (i ? "," : "") << '"' << phase_names[i]
+           << "\":{\"ns\":" << load(nanos_[i])
+           << ",\"calls\":" << load(calls_[i]) << '}';
+      os << "},\"counters\":{";
+      for (size_t i = 0; i < counter_count; ++i)
+        os << '"' << counter_names[i] << "\":" << load(counters_[i]) << ',';
+      os << "\"allocations\":" << allocations() << "}}\n";
+      return;
+    }
+
+    os << "hwmx stats, wall " << ms(wall) << " ms\n";
+    for (size_t i = 0; i < phase_count; ++i)
+      os << "  " << phase_names[i] << ": " << ms(load(nanos_[i])) << " ms in "
+         << load(calls_[i]) << " calls\n";
+    for (size_t i = 0; i < counter_count; ++i)
+      os << "  " << counter_names[i] << ": " << load(counters_[i]) << '\n';
+    os << "  allocations: " << allocations() << '\n';
+  }
+}; // class Stats
+
+// Adds its lifetime to phase, if stats were enabled at construction
+class ScopedTimer {
+  using Clock = std::chrono::steady_clock;
+
+  Phase phase_;
+  bool active_;
+  Clock::time_point start_{};
+
+public:
+  explicit ScopedTimer(Phase phase) noexcept
+      : phase_(phase), active_(Stats::global().enabled()) {
+    if (active_)
+      start_ = Clock::now();
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() {
+    if (active_)
+      Stats::global().addTime(phase_, Clock::now() - start_);
+  }
+}; // class ScopedTimer
+
+} // namespace mmm
@@ -0,0 +1,223 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include "Kernels.hpp"
+#include "ScratchPool.hpp"
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <numeric>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+// Index of the first nonzero of x[0, n), n if there is none. Zero runs are
+// checked in branch-free blocks, so the scan vectorizes.
+template <typename T> size_t firstNonzero(const T *x, size_t n) noexcept {
+  constexpr size_t block = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+  size_t i = 0;
+  for (; i + block <= n; i += block) {
+    bool any = false;
+    for (size_t k = 0; k < block; ++k)
+      any |= x[i + k] != T{0};
+    if (any)
+      break;
+  }
+  for (; i < n; ++i)
+    if (x[i] != T{0})
+      return i;
+  return n;
+}
+
+// One past the last nonzero of x[0, n), 0 if there is none
+template <typename T> size_t lastNonzeroEnd(const T *x, size_t n) noexcept {
+  constexpr size_t block = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+  size_t e = n;
+  for (; e >= block; e -= block) {
+    bool any = false;
+    for (size_t k = e - block; k < e; ++k)
+      any |= x[k] != T{0};
+    if (any)
+      break;
+  }
+  for (; e > 0; --e)
+    if (x[e - 1] != T{0})
+      return e;
+  return 0;
+}
+
+// Largest i - j and j - i over nonzero elements a_ij
+struct Bandwidths {
+  size_t lower = 0;
+  size_t upper = 0;
+
+  [[nodiscard]] bool triangular() const noexcept {
+    return lower == 0 || upper == 0;
+  }
+  [[nodiscard]] bool tridiagonal() const noexcept {
+    return lower <= 1 && upper <= 1;
+  }
+  // Band LU work is well below dense one
+  [[nodiscard]] bool banded(size_t n) const noexcept {
+    return (2 * lower + upper + 1) * 8 <= n;
+  }
+};
+
+// Only elements outside of the band found so far are checked, so dense
+// matrices cost O(n) and banded ones O(n * (n - b)) of vectorized compares
+template <typename T>
+Bandwidths bandwidths(const T *a, size_t n, size_t ld) noexcept {
+  Bandwidths res;
+  for (size_t i = 0; i < n; ++i) {
+    const T *ri = a + i * ld;
+    if (i > res.lower) {
+      size_t lim = i - res.lower;
+      if (size_t j = firstNonzero(ri, lim); j < lim)
+        res.lower = i - j;
+    }
+    if (size_t from = i + res.upper + 1; from < n)
+      if (size_t e = lastNonzeroEnd(ri + from, n - from))
+        res.upper = from + e - 1 - i;
+  }
+  return res;
+}
+
+// Connected components of the graph with edge (i, j) for each nonzero a_ij
+// inside band, each sorted. Empty if the matrix is connected, which dense
+// matrices reveal after their first rows.
+template <typename T>
+std::vector<std::vector<size_t>> components(const T *a, size_t n, size_t ld,
+                                            Bandwidths band) {
+  std::vector<size_t> parent(n);
+  std::iota(parent.begin(), parent.end(), size_t{0});
+  auto find = [&parent](size_t x) {
+    for (; parent[x] != x; x = parent[x])
+      parent[x] = parent[parent[x]];
+    return x;
+  };
+
+  size_t count = n;
+  for (size_t i = 0; i < n && count > 1; ++i) {
+    size_t lo = i - std::min(i, band.lower);
+    size_t hi = std::min(n, i + band.upper + 1);
+    for (size_t j = lo; j < hi; ++j) {
+      if (j == i || a[i * ld + j] == T{0})
+        continue;
+      size_t x = find(i), y = find(j);
+      if (x != y) {
+        parent[x] = y;
+        --count;
+      }
+    }
+  }
+  if (count <= 1)
+    return {};
+
+  std::vector<std::vector<size_t>> res;
+  std::vector<size_t> slot(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    size_t root = find(i);
+    if (slot[root] == n) {
+      slot[root] = res.size();
+      res.emplace_back();
+    }
+    res[slot[root]].push_back(i);
+  }
+  return res;
+}
+
+// Product of diagonal, determinant of triangular matrix. R is T for floating
+// T or exact type for integral one.
+template <typename R, typename T>
+R diagonalProduct(const T *a, size_t n, size_t ld) {
+  ScopedTimer timer(Phase::Eliminate);
+  Stats::global().add(Counter::Determinants);
+  R res(1);
+  for (size_t i = 0; i < n; ++i)
+    res = res * R(a[i * ld + i]);
+  return res;
+}
+
+// Continuant recurrence f_k = a_kk f_k-1 - a_k,k-1 a_k-1,k f_k-2
+template <typename R, typename T>
+R tridiagonalDet(const T *a, size_t n, size_t ld) {
+  ScopedTimer timer(Phase::Eliminate);
+  Stats::global().add(Counter::Determinants);
+  R prev(1);
+  R cur = n ? R(a[0]) : R(1);
+  for (size_t k = 1; k < n; ++k) {
+    R next = R(a[k * ld + k]) * cur -
+             R(a[k * ld + k - 1]) * R(a[(k - 1) * ld + k]) * prev;
+    prev = std::move(cur);
+    cur = std::move(next);
+  }
+  return cur;
+}
+
+// LU with partial pivoting of matrix with lower and upper bandwidths kl and
+// ku in O(n * kl * (kl + ku)). Pivoting widens upper band of U to kl + ku, so
+// row i keeps columns [i - kl, i + kl + ku] in compact storage.
+template <std::floating_point T>
+T bandDet(const T *a, size_t n, size_t ld, size_t kl, size_t ku) {
+  ScopedTimer timer(Phase::Eliminate);
+  Stats::global().add(Counter::Determinants);
+  size_t w = 2 * kl + ku + 1;
+  ScratchVector<T> band(n * w);
+  std::fill(band.begin(), band.end(), T{0});
+  auto at = [&band, w, kl](size_t i, size_t j) -> T & {
+    return band.begin()[i * w + j + kl - i];
+  };
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = i - std::min(i, kl); j < std::min(n, i + ku + 1); ++j)
+      at(i, j) = a[i * ld + j];
+
+  T res = 1;
+  for (size_t k = 0; k < n; ++k) {
+    size_t last = std::min(n - 1, k + kl);
+    size_t end = std::min(n, k + kl + ku + 1);
+    size_t p = k;
+    T max = std::abs(at(k, k));
+    for (size_t i = k + 1; i <= last; ++i)
+      if (auto cur = std::abs(at(i, k)); cur > max) {
+        max = cur;
+        p = i;
+      }
+    if (max == T{0})
+      return T{0};
+
+    if (p != k) {
+      for (size_t c = k; c < end; ++c)
+        std::swap(at(k, c), at(p, c));
+      res = -res;
+      Stats::global().add(Counter::Pivots);
+    }
+
+    T pivot = at(k, k);
+    res *= pivot;
+    for (size_t i = k + 1; i <= last; ++i)
+      if (T f = at(i, k) / pivot; f != T{0})
+        fmaSub(&at(i, k + 1), f, &at(k, k + 1), end - k - 1);
+  }
+  return res;
+}
+
+} // namespace mmm
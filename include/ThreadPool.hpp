@@ -0,0 +1,136 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace mmm { // my magic matrix
+
+class ThreadPool {
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+
+  void work() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(mtx_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (stop_ && tasks_.empty())
+          return;
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+public:
+  static unsigned hardwareThreads() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  explicit ThreadPool(unsigned threads = hardwareThreads()) {
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+      workers_.emplace_back([this] { work(); });
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &w : workers_)
+      w.join();
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return workers_.size(); }
+
+  template <std::invocable F> auto submit(F &&f) {
+    using Res = std::invoke_result_t<F>;
+    auto task =
+        std::make_shared<std::packaged_task<Res()>>(std::forward<F>(f));
+    auto res = task->get_future();
+    {
+      std::lock_guard lock(mtx_);
+      tasks_.emplace([task] { (*task)(); });
+    }
+    cv_.notify_one();
+    return res;
+  }
+
+  // Splits [begin, end) into contiguous chunks and calls f(lo, hi) on each.
+  // Calling thread takes the first chunk, so an empty pool runs inline.
+  template <typename F>
+  void parallelFor(size_t begin, size_t end, F &&f, size_t grain = 1) {
+    if (begin >= end)
+      return;
+
+    size_t total = end - begin;
+    size_t chunks = std::min(size() + 1, (total + grain - 1) / grain);
+    if (chunks <= 1) {
+      f(begin, end);
+      return;
+    }
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks - 1);
+    auto bound = [&](size_t c) { return begin + total * c / chunks; };
+    for (size_t c = 1; c < chunks; ++c)
+      pending.push_back(
+          submit([&f, lo = bound(c), hi = bound(c + 1)] { f(lo, hi); }));
+
+    std::exception_ptr err;
+    try {
+      f(bound(0), bound(1));
+    } catch (...) {
+      err = std::current_exception();
+    }
+
+    for (auto &p : pending)
+      try {
+        p.get();
+      } catch (...) {
+        if (!err)
+          err = std::current_exception();
+      }
+
+    if (err)
+      std::rethrow_exception(err);
+  }
+}; // class ThreadPool
+
+} // namespace mmm
@@ -0,0 +1,62 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <MappedInput.hpp>
+#include <Mmx.hpp>
+#include <Protocol.hpp>
+
+#include <iostream>
+#include <string_view>
+
+// Sends matrix from stdin (text or .mmx) to determinant server and prints
+// the reply
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " SOCKET [int|long|float|double]"
+              << std::endl;
+    return 2;
+  }
+
+  std::string_view name = argc > 2 ? argv[2] : "int";
+  mmm::WireType type = mmm::WireType::Int32;
+  if (name == "long")
+    type = mmm::WireType::Int64;
+  else if (name == "float")
+    type = mmm::WireType::Float32;
+  else if (name == "double")
+    type = mmm::WireType::Float64;
+  else if (name != "int") {
+    std::cerr << "Unknown element type: " << name << std::endl;
+    return 2;
+  }
+
+  try {
+    mmm::MappedInput input(STDIN_FILENO);
+    auto format = mmm::isMmx(input.text()) ? mmm::WireFormat::Mmx
+                                           : mmm::WireFormat::Text;
+    mmm::DetClient client(argv[1]);
+    client.send(0, format, type, input.text());
+    auto reply = client.receive();
+    (reply.ok ? std::cout : std::cerr) << reply.text << std::endl;
+    return reply.ok ? 0 : 1;
+  } catch (std::exception &e) {
+    std::cerr << __FILE__ << ": Exception caught in main(): " << e.what()
+              << std::endl;
+    return 1;
+  }
+}
@@ -16,20 +16,154 @@
 // hwmx. If not, see <https://www.gnu.org/licenses/>.
 // -------------------------------------------------------------------------- //
 
+#include <MappedInput.hpp>
+#include <Mmx.hpp>
 #include <Scanner.hpp>
+#include <Server.hpp>
+#include <Stats.hpp>
+#include <ThreadPool.hpp>
 
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
 
 #ifndef SCAN_TYPE
 #define SCAN_TYPE int
 #endif
 
-int main() {
+// Integer determinants are printed exactly, whatever their magnitude. Matrix
+// isn't used afterwards and is factorized in place.
+template <typename T> auto exactDet(const mmm::MatrixView<T> &m) {
+  if constexpr (std::integral<T>)
+    return m.detBigInplace();
+  else
+    return m.detInplace();
+}
+
+// Determinants of concatenated text matrices, one per line in input order.
+// Main thread parses next matrices while pool threads eliminate previous
+// ones; at most two matrices per thread are in flight.
+template <typename T> void runBatch(std::string_view text) {
+  mmm::ThreadPool pool;
+  size_t window = 2 * (pool.size() + 1);
+  std::deque<std::future<decltype(exactDet(mmm::Matrix<T>(1).view()))>>
+      pending;
+  auto emit = [&pending] {
+    auto res = pending.front().get();
+    mmm::ScopedTimer timer(mmm::Phase::Output);
+    std::cout << res << '\n';
+    pending.pop_front();
+  };
+
+  mmm::TextScanner scanner(text);
+  for (size_t k = 0; !scanner.atEnd(); ++k) {
+    std::optional<mmm::Matrix<T>> m;
+    try {
+      m.emplace(mmm::scanMatrix<T>(scanner));
+    } catch (std::exception &e) {
+      // Results before the bad matrix are still valid
+      while (!pending.empty())
+        emit();
+      throw std::runtime_error(std::string("Matrix ")
+                                   .append(std::to_string(k))
+                                   .append(": ")
+                                   .append(e.what()));
+    }
+
+    if (pending.size() == window)
+      emit();
+    pending.push_back(pool.submit(
+        [m = std::move(*m)] { return exactDet(m.view()); }));
+  }
+  while (!pending.empty())
+    emit();
+  std::cout.flush();
+}
+
+template <typename T> void print(const T &det) {
+  mmm::ScopedTimer timer(mmm::Phase::Output);
+  std::cout << det << std::endl;
+}
+
+// --stats[=text|json] flag or HWMX_STATS=text|json environment variable
+// enables report on stderr at exit. Flag is removed from args.
+std::optional<mmm::StatsFormat>
+statsFormat(std::vector<std::string_view> &args) {
+  std::optional<std::string_view> value;
+  if (const char *env = std::getenv("HWMX_STATS"); env && *env)
+    value = env;
+
+  std::erase_if(args, [&value](std::string_view arg) {
+    if (arg == "--stats")
+      value = "text";
+    else if (arg.starts_with("--stats="))
+      value = arg.substr(8);
+    else
+      return false;
+    return true;
+  });
+
+  if (!value || *value == "0")
+    return std::nullopt;
+  if (*value == "json")
+    return mmm::StatsFormat::Json;
+  return mmm::StatsFormat::Text;
+}
+
+int main(int argc, char **argv) {
+  std::vector<std::string_view> args(argv + 1, argv + argc);
+  auto stats = statsFormat(args);
+  if (stats)
+    mmm::Stats::global().enable();
+
   try {
-    auto m = mmm::magicScanner<SCAN_TYPE>(std::cin);
-    std::cout << m.det() << std::endl;
+    // Server answers requests of every element type, not only SCAN_TYPE
+    if (args.size() > 1 && args[0] == "--server") {
+      // Termination signals go to a dedicated thread, which stops the server
+      // so that it removes its socket file
+      sigset_t signals;
+      sigemptyset(&signals);
+      sigaddset(&signals, SIGINT);
+      sigaddset(&signals, SIGTERM);
+      pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+      mmm::DetServer server{std::string(args[1])};
+      std::thread([&server, signals] {
+        int sig;
+        sigwait(&signals, &sig);
+        server.stop();
+      }).detach();
+      server.run();
+    } else {
+      // Redirected files are mapped, pipes are read in large blocks. Mapping
+      // is private, so in place factorization doesn't touch the file.
+      mmm::MappedInput input(STDIN_FILENO, true);
+      if (!args.empty() && args[0] == "--batch") {
+        runBatch<SCAN_TYPE>(input.text());
+      } else if (mmm::isMmx(input.text())) {
+        mmm::MappedMatrix<SCAN_TYPE> m(std::move(input));
+        print(exactDet(m.view()));
+      } else {
+        auto m = mmm::magicScanner<SCAN_TYPE>(input.text(), {.threads = 0});
+        print(exactDet(m.view()));
+      }
+    }
   } catch (std::exception &e) {
     std::cerr << __FILE__ << ": Exception caught in main(): " << e.what()
               << std::endl;
   }
+
+  if (stats)
+    mmm::Stats::global().report(std::cerr, *stats);
 }
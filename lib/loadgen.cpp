@@ -0,0 +1,117 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Protocol.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Every connection keeps depth requests in flight and records latency of
+// each one from send to reply
+static std::vector<double> runConnection(const std::string &path,
+                                         size_t requests, size_t dim,
+                                         size_t depth, unsigned seed) {
+  std::mt19937 rand{seed};
+  std::string text = std::to_string(dim);
+  for (size_t i = 0; i < dim * dim; ++i)
+    text.append(" ").append(std::to_string(int(rand() % 21) - 10));
+
+  mmm::DetClient client(path);
+  std::vector<Clock::time_point> sent(requests);
+  std::vector<double> latency;
+  latency.reserve(requests);
+  size_t next = 0;
+  for (; next < std::min(depth, requests); ++next) {
+    sent[next] = Clock::now();
+    client.send(next, mmm::WireFormat::Text, mmm::WireType::Int32, text);
+  }
+
+  while (latency.size() < requests) {
+    auto reply = client.receive();
+    if (!reply.ok)
+      throw std::runtime_error(reply.text);
+    std::chrono::duration<double, std::micro> us =
+        Clock::now() - sent[reply.id];
+    latency.push_back(us.count());
+    if (next < requests) {
+      sent[next] = Clock::now();
+      client.send(next, mmm::WireFormat::Text, mmm::WireType::Int32, text);
+      ++next;
+    }
+  }
+  return latency;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " SOCKET [connections] [requests] [dim] [depth]" << std::endl;
+    return 2;
+  }
+
+  auto arg = [argc, argv](int i, size_t def) {
+    return argc > i ? std::stoul(argv[i]) : def;
+  };
+  size_t connections = arg(2, 4);
+  size_t requests = arg(3, 10000);
+  size_t dim = arg(4, 8);
+  size_t depth = arg(5, 16);
+
+  try {
+    std::vector<std::vector<double>> latency(connections);
+    std::vector<std::thread> threads;
+    std::exception_ptr err;
+    auto start = Clock::now();
+    for (size_t c = 0; c < connections; ++c)
+      threads.emplace_back([&, c] {
+        try {
+          latency[c] = runConnection(argv[1], requests, dim, depth, c);
+        } catch (...) {
+          err = std::current_exception();
+        }
+      });
+    for (auto &t : threads)
+      t.join();
+    if (err)
+      std::rethrow_exception(err);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::vector<double> all;
+    for (auto &l : latency)
+      all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    auto pct = [&all](double p) {
+      return all[std::min(all.size() - 1, size_t(p * all.size()))];
+    };
+    std::cout << all.size() << " requests in " << elapsed.count() << " s, "
+              << all.size() / elapsed.count() << " req/s\n"
+              << "latency us: p50 " << pct(0.5) << " p99 " << pct(0.99)
+              << " max " << all.back() << std::endl;
+  } catch (std::exception &e) {
+    std::cerr << __FILE__ << ": Exception caught in main(): " << e.what()
+              << std::endl;
+    return 1;
+  }
+}
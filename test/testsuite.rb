@@ -51,11 +51,16 @@ module Testsuite
       "#{prefix}_driver"
     end
 
-    def run_case(driver_bin, mtx)
-      driver_pipe = IO.popen(driver_bin, 'r+')
-      driver_pipe.puts mtx.column_size
-      mtx.each { |elem| driver_pipe.puts elem }
-      driver_pipe.gets
+    # All matrices go to one driver process, which prints determinants in
+    # input order
+    def run_batch(driver_bin, matrices)
+      driver_pipe = IO.popen([driver_bin, '--batch'], 'r+')
+      matrices.each do |mtx|
+        driver_pipe.puts mtx.column_size
+        mtx.each { |elem| driver_pipe.puts elem }
+      end
+      driver_pipe.close_write
+      driver_pipe.readlines
     ensure
       driver_pipe && driver_pipe.close
     end
@@ -68,8 +73,8 @@ module Testsuite
       driver_name = driver_for(type)
       driver_bin = bin(driver_name)
       matrices = Testgen.emit_mtx({type: type})
-      matrices.each do |mtx|
-        det = run_case(driver_bin, mtx)
+      dets = run_batch(driver_bin, matrices)
+      matrices.zip(dets).each do |mtx, det|
         verify(mtx, det)
         @verbose && puts("Success for size #{mtx.column_count} #{type.to_s}")
       rescue FailedTest
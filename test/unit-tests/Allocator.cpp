@@ -0,0 +1,77 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Allocator.hpp>
+#include <FixedVector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+class AllocatorTest : public ::testing::Test {
+protected:
+  static bool aligned(const void *p, size_t align) {
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+};
+
+TEST_F(AllocatorTest, Aligned) {
+  mmm::AlignedAllocator<double> alloc;
+  for (int i = 0; i < 16; ++i) {
+    size_t n = rand() % 1000 + 1;
+    double *p = alloc.allocate(n);
+    EXPECT_TRUE(aligned(p, 64));
+    alloc.deallocate(p, n);
+  }
+
+  mmm::AlignedAllocator<char, 4096> page;
+  char *p = page.allocate(1);
+  EXPECT_TRUE(aligned(p, 4096));
+  page.deallocate(p, 1);
+}
+
+TEST_F(AllocatorTest, WorksWithStdContainers) {
+  std::vector<int, mmm::AlignedAllocator<int>> v(rand() % 1000 + 1);
+  std::iota(v.begin(), v.end(), 0);
+  EXPECT_TRUE(aligned(v.data(), 64));
+  EXPECT_EQ(v.back(), int(v.size() - 1));
+  EXPECT_TRUE(mmm::AlignedAllocator<int>() == mmm::AlignedAllocator<char>());
+}
+
+TEST_F(AllocatorTest, HugePages) {
+  using Alloc = mmm::HugePageAllocator<double>;
+  size_t small = rand() % 1000 + 1;
+  size_t large = mmm::huge_page_size / sizeof(double) + rand() % 1000;
+
+  mmm::FixedVector<double, Alloc> s(small);
+  EXPECT_TRUE(aligned(s.begin(), 64));
+
+  mmm::FixedVector<double, Alloc> l(large);
+  EXPECT_TRUE(aligned(l.begin(), mmm::huge_page_size));
+  std::fill(l.begin(), l.end(), 1.0);
+  EXPECT_EQ(std::accumulate(l.begin(), l.end(), 0.0), double(large));
+
+  mmm::FixedVector<double, Alloc> copy(l);
+  EXPECT_TRUE(std::equal(l.begin(), l.end(), copy.begin()));
+}
@@ -0,0 +1,125 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Bareiss.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 12 };
+
+class BareissTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    v.resize(dim * dim);
+    std::ranges::generate(v, [this] { return int(rand() % 21) - 10; });
+  }
+
+  // Laplace expansion along first row, exact for small dims
+  static long long reference(const std::vector<int> &m, size_t n) {
+    if (n == 1)
+      return m[0];
+    long long res = 0;
+    for (size_t c = 0; c < n; ++c) {
+      std::vector<int> minor;
+      for (size_t i = 1; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+          if (j != c)
+            minor.push_back(m[i * n + j]);
+      long long sub = m[c] * reference(minor, n - 1);
+      res += (c % 2) ? -sub : sub;
+    }
+    return res;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::vector<int> v;
+};
+
+TEST_F(BareissTest, MatchesLaplace) {
+  size_t n = std::min<size_t>(dim, 7);
+  auto res = mmm::bareissDet(v.data(), n, dim);
+  std::vector<int> sub;
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      sub.push_back(v[i * dim + j]);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_TRUE(*res == reference(sub, n));
+}
+
+TEST_F(BareissTest, ZeroPivot) {
+  std::vector<int> m = {0, 2, 0, 0, 3, 0, 0, 0, 0, 0, 0, 5, 0, 0, 7, 0};
+  auto res = mmm::bareissDet(m.data(), 4, 4);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_TRUE(*res == 210);
+}
+
+TEST_F(BareissTest, Singular) {
+  for (size_t j = 0; j < dim; ++j)
+    v[(dim - 1) * dim + j] = 3 * v[j];
+  if (dim == 1)
+    v[0] = 0;
+  auto res = mmm::bareissDet(v.data(), dim, dim);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_TRUE(*res == 0);
+}
+
+TEST_F(BareissTest, ExactBeyondDouble) {
+  std::vector<long long> m = {3037000499, 12345, -7, 0, 3037000493, 11, 0, 0,
+                              1};
+  auto res = mmm::bareissDet(m.data(), 3, 3);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_TRUE(*res == mmm::Int128{3037000499} * 3037000493);
+}
+
+TEST_F(BareissTest, Int128Fallback) {
+  constexpr int big = std::numeric_limits<int>::max();
+  std::vector<int> m = {big, 1, 1, 1, big, 1, 1, 1, big};
+  auto res = mmm::bareissDet(m.data(), 3, 3);
+  ASSERT_TRUE(res.has_value());
+  mmm::Int128 b = big;
+  EXPECT_TRUE(*res == b * b * b - 3 * b + 2);
+}
+
+TEST_F(BareissTest, Overflow) {
+  constexpr long long big = std::numeric_limits<long long>::max();
+  std::vector<long long> m = {big, 1, 1, 1, big, 1, 1, 1, big};
+  EXPECT_FALSE(mmm::bareissDet(m.data(), 3, 3).has_value());
+
+}
+
+TEST_F(BareissTest, UnsignedBeyondInt64) {
+  std::vector<unsigned long long> u = {~0ull, 0, 5, 1};
+  auto res = mmm::bareissDet(u.data(), 2, 2);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_TRUE(*res == mmm::Int128{~0ull});
+}
+
+TEST_F(BareissTest, ParallelMatchesSequential) {
+  auto expect = mmm::bareissDet(v.data(), dim, dim);
+  mmm::ThreadPool pool(rand() % 4 + 1);
+  auto res = mmm::bareissDet(v.data(), dim, dim, &pool);
+  ASSERT_EQ(expect.has_value(), res.has_value());
+  if (res)
+    EXPECT_TRUE(*res == *expect);
+}
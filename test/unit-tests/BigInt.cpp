@@ -0,0 +1,106 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <BigInt.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <sstream>
+
+class BigIntTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    a = static_cast<long long>(rand()) - std::numeric_limits<int>::max();
+    b = static_cast<long long>(rand() % 1000) - 500;
+  }
+
+  std::mt19937_64 rand{std::random_device{}()};
+  long long a;
+  long long b;
+};
+
+TEST_F(BigIntTest, FromIntegral) {
+  EXPECT_EQ(mmm::BigInt(0).toString(), "0");
+  EXPECT_EQ(mmm::BigInt(a).toString(), std::to_string(a));
+  EXPECT_EQ(mmm::BigInt(-5).toString(), "-5");
+  EXPECT_EQ(mmm::BigInt(std::numeric_limits<long long>::min()).toString(),
+            "-9223372036854775808");
+  EXPECT_EQ(mmm::BigInt(std::numeric_limits<unsigned long long>::max())
+                .toString(),
+            "18446744073709551615");
+}
+
+TEST_F(BigIntTest, AddSub) {
+  auto x = mmm::BigInt(a), y = mmm::BigInt(b);
+  EXPECT_EQ((x + y).toString(), std::to_string(a + b));
+  EXPECT_EQ((x - y).toString(), std::to_string(a - b));
+  EXPECT_EQ((y - x).toString(), std::to_string(b - a));
+  EXPECT_TRUE((x - x).isZero());
+  EXPECT_FALSE((x - x).isNegative());
+}
+
+TEST_F(BigIntTest, MulAddPowerOfTen) {
+  mmm::BigInt x(1);
+  for (int i = 0; i < 40; ++i)
+    x.mulAdd(10, 0);
+  EXPECT_EQ(x.toString(), "1" + std::string(40, '0'));
+  x.mulAdd(1, 7);
+  EXPECT_EQ(x.toString(), "1" + std::string(39, '0') + "7");
+
+  std::ostringstream oss;
+  oss << -x;
+  EXPECT_EQ(oss.str(), "-1" + std::string(39, '0') + "7");
+}
+
+TEST_F(BigIntTest, Mul) {
+  auto x = mmm::BigInt(a), y = mmm::BigInt(b);
+  EXPECT_EQ(x * y, mmm::BigInt(static_cast<__int128>(a) * b));
+  EXPECT_TRUE((x * mmm::BigInt(0)).isZero());
+  EXPECT_FALSE((mmm::BigInt(-a) * mmm::BigInt(0)).isNegative());
+
+  // 10^20 * 10^20 crosses limbs of both factors
+  mmm::BigInt p(1);
+  for (int i = 0; i < 20; ++i)
+    p.mulAdd(10, 0);
+  EXPECT_EQ((p * -p).toString(), "-1" + std::string(40, '0'));
+}
+
+TEST_F(BigIntTest, Compare) {
+  auto x = mmm::BigInt(a), y = mmm::BigInt(b);
+  EXPECT_EQ(x < y, a < b);
+  EXPECT_EQ(x == y, a == b);
+  EXPECT_TRUE(mmm::BigInt(-3) < mmm::BigInt(2));
+  EXPECT_TRUE(mmm::BigInt(-3) < mmm::BigInt(-2));
+  EXPECT_TRUE(mmm::BigInt(3) > mmm::BigInt(2));
+}
+
+TEST_F(BigIntTest, Narrow) {
+  EXPECT_EQ(mmm::BigInt(a).narrow<long long>(), a);
+  EXPECT_EQ(mmm::BigInt(b).narrow<int>(), b);
+  EXPECT_EQ(mmm::BigInt(std::numeric_limits<int>::min()).narrow<int>(),
+            std::numeric_limits<int>::min());
+  EXPECT_FALSE(mmm::BigInt(1ll << 31).narrow<int>().has_value());
+  EXPECT_FALSE(mmm::BigInt(-1).narrow<unsigned>().has_value());
+
+  mmm::BigInt big(1);
+  for (int i = 0; i < 20; ++i)
+    big.mulAdd(1000, 0);
+  EXPECT_FALSE(big.narrow<long long>().has_value());
+}
@@ -0,0 +1,126 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Slice.hpp>
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+template <typename T> class ExprTest : public ::testing::Test {
+protected:
+  using TestType = T;
+  using Slice = mmm::Slice<TestType>;
+  using FixedVector = mmm::FixedVector<TestType>;
+
+  constexpr static auto min_size = 1;
+  constexpr static auto max_size = 128;
+
+  void SetUp() override {
+    size = rand() % (max_size - min_size) + min_size;
+    for (auto *v : {&a, &b, &c}) {
+      v->reserve(size);
+      std::ranges::for_each(std::views::iota(0u, size), [this, v](auto x) {
+        v->push_back(rand() % 1000 - 500);
+      });
+    }
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t size;
+  std::vector<TestType> a;
+  std::vector<TestType> b;
+  std::vector<TestType> c;
+};
+
+using ExprIntTest = ExprTest<int>;
+using ExprFloatTest = ExprTest<float>;
+
+TEST_F(ExprIntTest, ChainIntoFixedVectorInt) {
+  Slice sa(a), sb(b), sc(c);
+  TestType k1 = 3, k2 = -2;
+  FixedVector res = sa - k1 * sb + k2 * sc;
+  ASSERT_EQ(res.size(), size);
+  for (auto i : std::views::iota(0u, size))
+    EXPECT_EQ(res[i], a[i] - k1 * b[i] + k2 * c[i]);
+}
+
+TEST_F(ExprFloatTest, ChainIntoSliceFloat) {
+  std::vector<TestType> dst(size, 0);
+  Slice sd(dst), sa(a), sb(b), sc(c);
+  TestType k1 = 0.5, k2 = 2;
+  sd = sa - k1 * sb + k2 * sc / 4.0f;
+  for (auto i : std::views::iota(0u, size))
+    EXPECT_FLOAT_EQ(dst[i], a[i] - k1 * b[i] + k2 * c[i] / 4.0f);
+}
+
+TEST_F(ExprIntTest, StridedInt) {
+  for (const auto stride : std::views::iota(1u, size)) {
+    std::vector<TestType> dst = a;
+    size_t sliceSize = size / stride + (size % stride != 0);
+    Slice sd(dst.data(), size, 0, stride, sliceSize);
+    Slice sb(b.data(), size, 0, stride, sliceSize);
+    Slice sc(c.data(), size, 0, 1, sliceSize);
+    sd -= 2 * sb - sc;
+    for (auto i : std::views::iota(0u, sliceSize))
+      EXPECT_EQ(dst[i * stride], a[i * stride] - (2 * b[i * stride] - c[i]));
+  }
+}
+
+TEST_F(ExprFloatTest, CompoundFloat) {
+  std::vector<TestType> dst = a;
+  Slice sd(dst), sb(b), sc(c);
+  sd += sb * sc;
+  sd *= 2.0f * sb;
+  sd /= sb - 1000.0f;
+  for (auto i : std::views::iota(0u, size))
+    EXPECT_FLOAT_EQ(dst[i],
+                    (a[i] + b[i] * c[i]) * (2 * b[i]) / (b[i] - 1000.0f));
+}
+
+TEST_F(ExprFloatTest, ScaledSubFloat) {
+  std::vector<TestType> dst = a;
+  Slice sd(dst), sb(b);
+  TestType k = 0.25;
+  sd -= k * sb;
+  for (auto i : std::views::iota(0u, size))
+    EXPECT_FLOAT_EQ(dst[i], a[i] - k * b[i]);
+}
+
+TEST_F(ExprIntTest, FixedVectorOperandsInt) {
+  FixedVector fa(a), fb(b);
+  FixedVector res = 1 - fa * fb + Slice(c);
+  for (auto i : std::views::iota(0u, size))
+    EXPECT_EQ(res[i], 1 - a[i] * b[i] + c[i]);
+}
+
+TEST_F(ExprIntTest, LazyIndexInt) {
+  Slice sa(a);
+  auto e = 2 * sa + 1;
+  EXPECT_EQ(e.size(), size);
+  a[0] = 7;
+  EXPECT_EQ(e[0], 15);
+}
+
+TEST_F(ExprIntTest, SizeMismatchInt) {
+  if (size < 2)
+    return;
+  Slice sa(a.data(), size, 0, 1, size), sb(b.data(), size, 0, 1, size - 1);
+  EXPECT_THROW(sa + sb, std::runtime_error);
+  EXPECT_THROW(sa += 2 * sb, std::runtime_error);
+}
@@ -20,7 +20,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <random>
+#include <string>
+#include <vector>
 
 enum { MAX_SIZE = 128 };
 
@@ -195,3 +198,40 @@ TEST_F(FixedVectorFloatTest, ElemAccessFloat) {
     EXPECT_EQ(fv[i], v[i]);
   EXPECT_THROW(auto x = fv[size], std::out_of_range);
 }
+
+TEST_F(FixedVectorIntTest, CopyAssignExisting) {
+  mmm::FixedVector<TestType> fv(v);
+  mmm::FixedVector<TestType> other(size + 1);
+  auto &res = (other = fv);
+  EXPECT_EQ(&res, &other);
+  EXPECT_TRUE(std::ranges::equal(other, v));
+  other = other;
+  EXPECT_TRUE(std::ranges::equal(other, v));
+}
+
+TEST_F(FixedVectorFloatTest, MoveAssignExisting) {
+  mmm::FixedVector<TestType> fv(v);
+  mmm::FixedVector<TestType> other(size + 1);
+  auto &res = (other = std::move(fv));
+  EXPECT_EQ(&res, &other);
+  EXPECT_EQ(fv.size(), 0);
+  EXPECT_TRUE(std::ranges::equal(other, v));
+}
+
+TEST_F(FixedVectorFloatTest, CacheLineAligned) {
+  mmm::FixedVector<TestType> fv(size + 1);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(fv.begin()) % 64, 0);
+}
+
+TEST_F(FixedVectorIntTest, NonTrivialElements) {
+  mmm::FixedVector<std::string> empty(size);
+  EXPECT_TRUE(std::ranges::all_of(empty, &std::string::empty));
+
+  std::vector<std::string> strs;
+  for (auto x : v)
+    strs.push_back(std::to_string(x) + " is long enough to be on heap");
+  mmm::FixedVector<std::string> fv(strs);
+  mmm::FixedVector<std::string> copy(fv);
+  copy = fv;
+  EXPECT_TRUE(std::ranges::equal(copy, strs));
+}
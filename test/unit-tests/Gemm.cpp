@@ -0,0 +1,170 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Gemm.hpp>
+#include <Matrix.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 150 };
+
+template <typename T> class GemmTest : public ::testing::Test {
+protected:
+  using TestType = T;
+
+  void SetUp() override {
+    m = rand() % MAX_DIM + 1;
+    n = rand() % MAX_DIM + 1;
+    k = rand() % MAX_DIM + 1;
+    a = random(m * k);
+    b = random(k * n);
+    c = random(m * n);
+  }
+
+  std::vector<T> random(size_t size) {
+    std::vector<T> v(size);
+    std::ranges::generate(
+        v, [this] { return static_cast<T>(int(rand() % 21) - 10); });
+    return v;
+  }
+
+  // c + alpha * a * b by definition
+  std::vector<T> naive(T alpha) const {
+    auto res = c;
+    for (size_t i = 0; i < m; ++i)
+      for (size_t j = 0; j < n; ++j) {
+        T sum{};
+        for (size_t p = 0; p < k; ++p)
+          sum += a[i * k + p] * b[p * n + j];
+        res[i * n + j] += alpha * sum;
+      }
+    return res;
+  }
+
+  // Small entries keep every sum exact in floating point types too
+  void expectEqual(const std::vector<T> &res, const std::vector<T> &ref) {
+    ASSERT_EQ(res.size(), ref.size());
+    for (size_t i = 0; i < res.size(); ++i)
+      ASSERT_EQ(res[i], ref[i]) << "at " << i;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t m, n, k;
+  std::vector<T> a, b, c;
+};
+
+using GemmTypes = ::testing::Types<float, double, int, long long>;
+TYPED_TEST_SUITE(GemmTest, GemmTypes);
+
+TYPED_TEST(GemmTest, MatchesNaive) {
+  using T = typename TestFixture::TestType;
+  auto ref = this->naive(T{3});
+  mmm::gemm(this->m, this->n, this->k, T{3}, this->a.data(), this->k,
+            this->b.data(), this->n, this->c.data(), this->n);
+  this->expectEqual(this->c, ref);
+}
+
+TYPED_TEST(GemmTest, SmallBlocks) {
+  using T = typename TestFixture::TestType;
+  auto ref = this->naive(T{-1});
+  mmm::GemmParams params{.mc = 7, .kc = 5, .nc = 3};
+  mmm::gemm(this->m, this->n, this->k, T{-1}, this->a.data(), this->k,
+            this->b.data(), this->n, this->c.data(), this->n, nullptr, params);
+  this->expectEqual(this->c, ref);
+}
+
+TYPED_TEST(GemmTest, Parallel) {
+  using T = typename TestFixture::TestType;
+  auto ref = this->naive(T{1});
+  mmm::ThreadPool pool(3);
+  mmm::GemmParams params{.mc = 16, .kc = 32, .nc = 64};
+  mmm::gemm(this->m, this->n, this->k, T{1}, this->a.data(), this->k,
+            this->b.data(), this->n, this->c.data(), this->n, &pool, params);
+  this->expectEqual(this->c, ref);
+}
+
+TYPED_TEST(GemmTest, PermutedRows) {
+  using T = typename TestFixture::TestType;
+  auto ref = this->naive(T{1});
+
+  // C rows stored in reverse order, A rows with padding
+  size_t lda = this->k + 3;
+  std::vector<T> pa(this->m * lda);
+  for (size_t i = 0; i < this->m; ++i)
+    std::copy_n(this->a.begin() + i * this->k, this->k, pa.begin() + i * lda);
+  size_t m = this->m, n = this->n;
+  std::vector<T> rc(m * n);
+  for (size_t i = 0; i < m; ++i)
+    std::copy_n(this->c.begin() + i * n, n, rc.begin() + (m - 1 - i) * n);
+
+  T *cdata = rc.data();
+  mmm::gemm(
+      m, n, this->k, T{1}, [&pa, lda](size_t i) { return pa.data() + i * lda; },
+      [this](size_t p) { return this->b.data() + p * this->n; },
+      [cdata, m, n](size_t i) { return cdata + (m - 1 - i) * n; });
+
+  std::vector<T> res(m * n);
+  for (size_t i = 0; i < m; ++i)
+    std::copy_n(rc.begin() + (m - 1 - i) * n, n, res.begin() + i * n);
+  this->expectEqual(res, ref);
+}
+
+TYPED_TEST(GemmTest, MatrixProduct) {
+  using T = typename TestFixture::TestType;
+  size_t dim = this->m;
+  auto a = this->random(dim * dim);
+  auto b = this->random(dim * dim);
+  mmm::Matrix<T> ma(a.begin(), dim), mb(b.begin(), dim);
+
+  auto prod = ma * mb;
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j) {
+      T sum{};
+      for (size_t p = 0; p < dim; ++p)
+        sum += a[i * dim + p] * b[p * dim + j];
+      ASSERT_EQ(prod(i, j), sum);
+    }
+
+  EXPECT_THROW(ma * mmm::Matrix<T>(dim + 1), std::runtime_error);
+}
+
+TYPED_TEST(GemmTest, MatrixVector) {
+  using T = typename TestFixture::TestType;
+  size_t dim = this->m;
+  auto a = this->random(dim * dim);
+  auto x = this->random(dim);
+  mmm::Matrix<T> ma(a.begin(), dim);
+  mmm::FixedVector<T> vx(x.begin(), dim);
+
+  mmm::ThreadPool pool(2);
+  auto y = ma * vx;
+  auto yp = ma.mul(vx, &pool);
+  for (size_t i = 0; i < dim; ++i) {
+    T sum{};
+    for (size_t j = 0; j < dim; ++j)
+      sum += a[i * dim + j] * x[j];
+    EXPECT_EQ(y[i], sum);
+    EXPECT_EQ(yp[i], sum);
+  }
+}
@@ -0,0 +1,129 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Kernels.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+template <typename T> class KernelsTest : public ::testing::Test {
+protected:
+  using TestType = T;
+
+  constexpr static size_t max_size = 300;
+
+  void SetUp() override {
+    std::uniform_real_distribution<TestType> dist(-1, 1);
+    x.resize(max_size);
+    y.resize(max_size);
+    std::ranges::generate(x, [this, &dist] { return dist(rand); });
+    std::ranges::generate(y, [this, &dist] { return dist(rand); });
+    alpha = dist(rand);
+  }
+
+  void checkIsa(mmm::KernelIsa isa, TestType eps) {
+    auto kernel = mmm::fmaSubKernel<TestType>(isa);
+    for (size_t off : {0, 1, 3})
+      for (size_t n = 0; n + off <= max_size; n += 7) {
+        std::vector<TestType> res = y;
+        kernel(res.data() + off, alpha, x.data() + off, n);
+        for (size_t i = 0; i < max_size; ++i) {
+          bool inside = i >= off && i < off + n;
+          TestType expect = inside ? y[i] - alpha * x[i] : y[i];
+          EXPECT_NEAR(res[i], expect, eps);
+        }
+      }
+  }
+
+  // Compares with log-sum in long double for every length
+  void checkSignLog(TestType eps) {
+    for (size_t n = 0; n <= max_size; n += 7) {
+      long double expect = 0;
+      bool negative = false;
+      for (size_t i = 0; i < n; ++i) {
+        expect += std::log(std::abs(static_cast<long double>(x[i])));
+        negative ^= x[i] < 0;
+      }
+      auto [sign, res] = mmm::signLogProduct(x.data(), n);
+      EXPECT_EQ(sign, negative ? -1 : 1);
+      EXPECT_NEAR(res, expect, eps * std::max(1.0L, std::abs(expect)));
+    }
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  std::vector<TestType> x;
+  std::vector<TestType> y;
+  TestType alpha;
+};
+
+using KernelsFloatTest = KernelsTest<float>;
+using KernelsDoubleTest = KernelsTest<double>;
+
+TEST_F(KernelsFloatTest, FmaSubFloat) {
+  auto isa = mmm::detectIsa();
+  checkIsa(mmm::KernelIsa::Scalar, 1e-6);
+  if (isa >= mmm::KernelIsa::Avx2)
+    checkIsa(mmm::KernelIsa::Avx2, 1e-6);
+  if (isa >= mmm::KernelIsa::Avx512)
+    checkIsa(mmm::KernelIsa::Avx512, 1e-6);
+}
+
+TEST_F(KernelsDoubleTest, FmaSubDouble) {
+  auto isa = mmm::detectIsa();
+  checkIsa(mmm::KernelIsa::Scalar, 1e-14);
+  if (isa >= mmm::KernelIsa::Avx2)
+    checkIsa(mmm::KernelIsa::Avx2, 1e-14);
+  if (isa >= mmm::KernelIsa::Avx512)
+    checkIsa(mmm::KernelIsa::Avx512, 1e-14);
+}
+
+TEST(Kernels, FmaSubInt) {
+  std::vector<int> y = {1, 2, 3, 4, 5};
+  std::vector<int> x = {5, 4, 3, 2, 1};
+  mmm::fmaSub(y.data(), 2, x.data(), y.size());
+  EXPECT_EQ(y, (std::vector<int>{-9, -6, -3, 0, 3}));
+}
+
+TEST_F(KernelsFloatTest, SignLogProductFloat) {
+  checkSignLog(1e-5);
+  // Product of huge values overflows float many times over
+  std::ranges::transform(x, x.begin(), [](float f) { return f * 1e30f; });
+  checkSignLog(1e-5);
+}
+
+TEST_F(KernelsDoubleTest, SignLogProductDouble) {
+  checkSignLog(1e-12);
+  std::ranges::transform(x, x.begin(), [](double d) { return d * 1e-300; });
+  checkSignLog(1e-12);
+}
+
+TEST_F(KernelsDoubleTest, SignLogProductSpecial) {
+  // Subnormals are handled by the scalar path
+  x[rand() % 64] = std::numeric_limits<double>::denorm_min();
+  checkSignLog(1e-12);
+
+  x[rand() % 64] = 0;
+  auto [sign, res] = mmm::signLogProduct(x.data(), 64);
+  EXPECT_EQ(sign, 0);
+  EXPECT_EQ(res, -std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,187 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <LU.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 96 };
+
+template <typename T> class LUTest : public ::testing::Test {
+protected:
+  using TestType = T;
+  using LU = mmm::BlockedLU<TestType>;
+
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    v.resize(dim * dim);
+    std::uniform_real_distribution<TestType> dist(-1, 1);
+    std::ranges::generate(v, [this, &dist] { return dist(rand); });
+  }
+
+  // Upper triangular U with known det, then rows shuffled and mixed with
+  // lower rows to get dense matrix with the same det up to permutation sign
+  TestType makeKnown(std::vector<TestType> &m, bool zeroLead) {
+    m.assign(dim * dim, 0);
+    TestType expect = 1;
+    for (size_t i = 0; i < dim; ++i) {
+      m[i * dim + i] = (i % 2) ? 2 : -0.5;
+      expect *= m[i * dim + i];
+      for (size_t j = i + 1; j < dim; ++j)
+        m[i * dim + j] = v[i * dim + j];
+    }
+
+    for (size_t i = 1; i < dim; ++i)
+      for (size_t k = 0; k < i; ++k)
+        for (size_t j = 0; j < dim; ++j)
+          m[i * dim + j] += v[k * dim + i] * m[k * dim + j] / dim;
+
+    if (zeroLead && dim > 1) {
+      for (size_t j = 0; j < dim; ++j)
+        std::swap(m[j], m[dim + j]);
+      expect = -expect;
+    }
+    return expect;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::vector<TestType> v;
+};
+
+using LUFloatTest = LUTest<float>;
+using LUDoubleTest = LUTest<double>;
+
+TEST_F(LUDoubleTest, DetKnownDouble) {
+  std::vector<TestType> m;
+  auto expect = makeKnown(m, false);
+  LU lu(m.data(), dim, dim);
+  EXPECT_NEAR(lu.factorize().det() / expect, 1.0, 1e-8);
+}
+
+TEST_F(LUFloatTest, DetKnownFloat) {
+  dim = std::min<size_t>(dim, 16);
+  std::vector<TestType> m;
+  auto expect = makeKnown(m, false);
+  LU lu(m.data(), dim, dim);
+  EXPECT_NEAR(lu.factorize().det() / expect, 1.0f, 1e-2f);
+}
+
+TEST_F(LUDoubleTest, ZeroLeadingPivotDouble) {
+  std::vector<TestType> m = {0, 1, 1, 0};
+  LU lu(m.data(), 2, 2);
+  EXPECT_DOUBLE_EQ(lu.factorize().det(), -1.0);
+  EXPECT_EQ(lu.swaps(), 1);
+
+  std::vector<TestType> known;
+  auto expect = makeKnown(known, true);
+  LU luKnown(known.data(), dim, dim);
+  EXPECT_NEAR(luKnown.factorize().det() / expect, 1.0, 1e-8);
+}
+
+TEST_F(LUDoubleTest, SingularDouble) {
+  std::vector<TestType> m = v;
+  for (size_t i = 0; i < dim; ++i)
+    m[i * dim + dim - 1] = 0;
+
+  LU lu(m.data(), dim, dim);
+  EXPECT_EQ(lu.factorize().det(), 0.0);
+  EXPECT_TRUE(lu.singular());
+}
+
+TEST_F(LUDoubleTest, SlogdetKnownDouble) {
+  std::vector<TestType> m;
+  auto expect = makeKnown(m, rand() % 2);
+  LU lu(m.data(), dim, dim);
+  auto [sign, logAbs] = lu.factorize().slogdet();
+  EXPECT_EQ(sign, expect < 0 ? -1 : 1);
+  EXPECT_NEAR(logAbs, std::log(std::abs(expect)), 1e-8);
+
+  std::vector<TestType> zero(dim * dim, 0);
+  auto singular = LU(zero.data(), dim, dim).factorize().slogdet();
+  EXPECT_EQ(singular.sign, 0);
+  EXPECT_TRUE(std::isinf(singular.logAbs) && singular.logAbs < 0);
+}
+
+TEST_F(LUFloatTest, SlogdetOverflowFloat) {
+  // Scaled identity with reversed rows, det overflows float for dim > 1
+  dim = std::max<size_t>(dim, 2);
+  std::vector<TestType> m(dim * dim, 0);
+  for (size_t i = 0; i < dim; ++i)
+    m[i * dim + dim - 1 - i] = 1e30f;
+
+  LU lu(m.data(), dim, dim);
+  lu.factorize();
+  EXPECT_TRUE(std::isinf(lu.det()));
+  auto [sign, logAbs] = lu.slogdet();
+  EXPECT_EQ(sign, lu.swaps() % 2 ? -1 : 1);
+  EXPECT_NEAR(logAbs / (dim * std::log(1e30)), 1.0, 1e-5);
+}
+
+TEST_F(LUDoubleTest, BlockingInvariantDouble) {
+  std::vector<TestType> ref = v;
+  auto expect = LU(ref.data(), dim, dim, {1, 1}).factorize().det();
+
+  for (auto params : {mmm::LUParams{4, 8}, mmm::LUParams{7, 3},
+                      mmm::LUParams{32, 256}, mmm::LUParams{128, 1024}}) {
+    std::vector<TestType> m = v;
+    LU lu(m.data(), dim, dim, params);
+    EXPECT_NEAR(lu.factorize().det(), expect, 1e-9 * std::abs(expect) + 1e-12);
+  }
+}
+
+TEST_F(LUDoubleTest, LeadingDimensionDouble) {
+  size_t ld = dim + 3;
+  std::vector<TestType> padded(dim * ld, 42);
+  for (size_t i = 0; i < dim; ++i)
+    std::ranges::copy_n(v.begin() + i * dim, dim, padded.begin() + i * ld);
+
+  std::vector<TestType> m = v;
+  auto expect = LU(m.data(), dim, dim).factorize().det();
+  LU lu(padded.data(), dim, ld);
+  EXPECT_NEAR(lu.factorize().det(), expect, 1e-9 * std::abs(expect) + 1e-12);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = dim; j < ld; ++j)
+      EXPECT_EQ(padded[i * ld + j], 42);
+}
+
+TEST_F(LUDoubleTest, PermIsPermutationDouble) {
+  std::vector<TestType> m = v;
+  LU lu(m.data(), dim, dim, {3, 5});
+  lu.factorize();
+  std::vector<size_t> perm(lu.perm().begin(), lu.perm().end());
+  std::ranges::sort(perm);
+  for (size_t i = 0; i < dim; ++i)
+    EXPECT_EQ(perm[i], i);
+}
+
+TEST_F(LUDoubleTest, ParallelMatchesSequentialDouble) {
+  std::vector<TestType> ref = v;
+  mmm::LUParams params{8, 16, 4};
+  auto expect = LU(ref.data(), dim, dim, params).factorize().det();
+
+  mmm::ThreadPool pool(rand() % 4 + 1);
+  std::vector<TestType> m = v;
+  LU lu(m.data(), dim, dim, params, &pool);
+  EXPECT_EQ(lu.factorize().det(), expect);
+  EXPECT_TRUE(std::ranges::equal(m, ref));
+}
@@ -0,0 +1,151 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <LUFactorization.hpp>
+#include <Matrix.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 60, MAX_PAD = 5 };
+
+class LUFactorizationTest : public ::testing::Test {
+protected:
+  void SetUp() override { dim = rand() % MAX_DIM + 1; }
+
+  // Diagonally dominant, so solutions are well conditioned
+  mmm::Matrix<double> regular(size_t n) {
+    mmm::Matrix<double> m(n);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    std::ranges::generate(m, [this, &dist] { return dist(rand); });
+    for (size_t i = 0; i < n; ++i)
+      m(i, i) += i % 2 ? -double(n) : double(n);
+    return m;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+};
+
+TEST_F(LUFactorizationTest, SolveAndInverse) {
+  size_t ld = dim + rand() % MAX_PAD;
+  std::vector<int> buf(dim * ld);
+  std::ranges::generate(buf, [this] { return int(rand() % 21) - 10; });
+  for (size_t i = 0; i < dim; ++i)
+    buf[i * ld + i] += 11 * int(dim);
+
+  mmm::LUFactorization<double> lu(buf.data(), dim, ld);
+  EXPECT_EQ(lu.dim(), dim);
+  EXPECT_FALSE(lu.singular());
+
+  mmm::FixedVector<double> x(dim);
+  std::ranges::generate(x, [this] { return double(rand() % 100) - 50; });
+  mmm::FixedVector<double> b(dim);
+  for (size_t i = 0; i < dim; ++i) {
+    b[i] = 0;
+    for (size_t j = 0; j < dim; ++j)
+      b[i] += buf[i * ld + j] * x[j];
+  }
+  auto res = lu.solve(b);
+  for (size_t i = 0; i < dim; ++i)
+    EXPECT_NEAR(res[i], x[i], 1e-9);
+
+  auto inv = lu.inverse();
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j) {
+      double sum = 0;
+      for (size_t k = 0; k < dim; ++k)
+        sum += buf[i * ld + k] * inv[k * dim + j];
+      EXPECT_NEAR(sum, i == j, 1e-12);
+    }
+
+  EXPECT_THROW(lu.solve(mmm::FixedVector<double>(dim + 1)),
+               std::runtime_error);
+}
+
+TEST_F(LUFactorizationTest, SingularThrows) {
+  mmm::Matrix<double> m(dim + 1);
+  std::ranges::generate(m, [this] { return double(rand() % 21) - 10; });
+  size_t j = rand() % (dim + 1);
+  for (size_t i = 0; i < m.dim(); ++i)
+    m(i, j) = 0;
+
+  auto lu = m.lu();
+  EXPECT_TRUE(lu->singular());
+  EXPECT_EQ(lu->det(), 0);
+  EXPECT_THROW(m.solve(mmm::FixedVector<double>(m.dim())), std::runtime_error);
+  EXPECT_THROW(m.inverse(), std::runtime_error);
+}
+
+TEST_F(LUFactorizationTest, MatrixCachesUntilMutation) {
+  auto m = regular(dim + mmm::max_static_dim);
+  auto lu = m.lu();
+  double ref = m.det();
+  EXPECT_EQ(m.lu(), lu);
+  EXPECT_EQ(ref, lu->det());
+  auto [sign, logAbs] = m.slogdet();
+  EXPECT_EQ(m.lu(), lu);
+  EXPECT_EQ(sign, ref < 0 ? -1 : 1);
+  EXPECT_NEAR(logAbs, std::log(std::abs(ref)), 1e-9);
+
+  // Copies share immutable factorization
+  auto copy = m;
+  EXPECT_EQ(copy.lu(), lu);
+
+  // Doubled row doubles determinant
+  size_t i = rand() % m.dim();
+  for (size_t j = 0; j < m.dim(); ++j)
+    m(i, j) *= 2;
+  EXPECT_NE(m.lu(), lu);
+  EXPECT_NEAR(m.det() / ref, 2.0, 1e-12);
+  EXPECT_EQ(copy.lu(), lu);
+
+  auto before = m.lu();
+  std::fill(m.begin(), m.begin() + m.dim(), 0.0);
+  EXPECT_NE(m.lu(), before);
+  EXPECT_EQ(m.det(), 0);
+
+  m = copy;
+  EXPECT_EQ(m.lu(), lu);
+  EXPECT_EQ(m.det(), ref);
+}
+
+TEST_F(LUFactorizationTest, MatrixSolveAndInverse) {
+  auto m = regular(dim);
+  auto inv = m.inverse();
+  auto id = m * inv;
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j)
+      EXPECT_NEAR(id(i, j), i == j, 1e-12);
+
+  // Integral matrices are solved in double
+  mmm::Matrix<int> im(dim);
+  std::ranges::generate(im, [this] { return int(rand() % 21) - 10; });
+  for (size_t k = 0; k < dim; ++k)
+    im(k, k) = 11 * int(dim);
+  mmm::FixedVector<double> x(dim);
+  std::ranges::generate(x, [this] { return double(rand() % 100) - 50; });
+  mmm::FixedVector<double> b = mmm::Matrix<double>(im) * x;
+  auto res = im.solve(b);
+  for (size_t k = 0; k < dim; ++k)
+    EXPECT_NEAR(res[k], x[k], 1e-9);
+}
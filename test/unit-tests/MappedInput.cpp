@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <MappedInput.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+enum { MAX_SIZE = 1 << 21 };
+
+class MappedInputTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    text.resize(rand() % MAX_SIZE + 1);
+    std::ranges::generate(text, [this] { return char('a' + rand() % 26); });
+    path = std::filesystem::temp_directory_path() /
+           ("hwmx-mapped-" + std::to_string(rand()));
+    std::ofstream(path, std::ios::binary) << text;
+  }
+
+  void TearDown() override { std::filesystem::remove(path); }
+
+  std::mt19937 rand{std::random_device{}()};
+  std::string text;
+  std::filesystem::path path;
+};
+
+TEST_F(MappedInputTest, MapsRegularFile) {
+  mmm::MappedInput in(path.string());
+  EXPECT_TRUE(in.mapped());
+  EXPECT_EQ(in.text(), text);
+}
+
+TEST_F(MappedInputTest, StartsAtDescriptorOffset) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  size_t offset = rand() % text.size();
+  ::lseek(fd, static_cast<off_t>(offset), SEEK_SET);
+  mmm::MappedInput in(fd);
+  ::close(fd);
+  EXPECT_EQ(in.text(), std::string_view(text).substr(offset));
+}
+
+TEST_F(MappedInputTest, ReadsPipe) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  std::string small = text.substr(0, 4096);
+  ASSERT_EQ(::write(fds[1], small.data(), small.size()),
+            static_cast<ssize_t>(small.size()));
+  ::close(fds[1]);
+
+  mmm::MappedInput in(fds[0]);
+  ::close(fds[0]);
+  EXPECT_FALSE(in.mapped());
+  EXPECT_EQ(in.text(), small);
+
+  mmm::MappedInput moved(std::move(in));
+  EXPECT_EQ(moved.text(), small);
+}
+
+TEST_F(MappedInputTest, MissingFile) {
+  EXPECT_THROW(mmm::MappedInput((path / "missing").string()),
+               std::system_error);
+}
@@ -280,3 +280,90 @@ TEST_F(MatrixFloatTest, DetFloat) {
   mmm::Matrix<TestType> m3(v3.data(), 3);
   EXPECT_FLOAT_EQ(m3.det(), 1.0);
 }
+
+TEST_F(MatrixIntTest, DetZeroLeadingPivotInt) {
+  std::vector<TestType> v3 = {0, 1, 0, 1, 0, 0, 0, 0, 1};
+  mmm::Matrix<TestType> m3(v3.data(), 3);
+  EXPECT_EQ(m3.det(), -1);
+
+  std::vector<TestType> v4 = {0, 2, 0, 0, 3, 0, 0, 0, 0, 0, 0, 5, 0, 0, 7, 0};
+  mmm::Matrix<TestType> m4(v4.data(), 4);
+  EXPECT_EQ(m4.det(), 210);
+}
+
+TEST_F(MatrixFloatTest, DetZeroLeadingPivotFloat) {
+  std::vector<TestType> v3 = {0, 1, 0, 1, 0, 0, 0, 0, 1};
+  mmm::Matrix<TestType> m3(v3.data(), 3);
+  EXPECT_FLOAT_EQ(m3.det(), -1.0);
+
+  std::vector<TestType> v4 = {0, 2, 0, 0, 3, 0, 0, 0, 0, 0, 0, 5, 0, 0, 7, 0};
+  mmm::Matrix<TestType> m4(v4.data(), 4);
+  EXPECT_FLOAT_EQ(m4.det(), 210.0);
+}
+
+TEST_F(MatrixIntTest, DetSingularInt) {
+  std::vector<TestType> v3 = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  mmm::Matrix<TestType> m3(v3.data(), 3);
+  EXPECT_EQ(m3.det(), 0);
+}
+
+TEST_F(MatrixIntTest, DetKnownInt) {
+  std::vector<TestType> v3 = {2, -3, 1, 2, 0, -1, 1, 4, 5};
+  mmm::Matrix<TestType> m3(v3.data(), 3);
+  EXPECT_EQ(m3.det(), 49);
+}
+
+TEST_F(MatrixFloatTest, DetParallelFloat) {
+  mmm::Matrix<TestType> m(v.data(), dim);
+  mmm::DetPolicy policy{.threads = 4, .minParallelDim = 0};
+  policy.blocking.grain = 1;
+  EXPECT_FLOAT_EQ(m.det(policy), m.det());
+
+  mmm::ThreadPool pool(2);
+  EXPECT_FLOAT_EQ(m.det({.pool = &pool, .minParallelDim = 0}), m.det());
+}
+
+TEST_F(MatrixFloatTest, DetRvalueFloat) {
+  mmm::Matrix<TestType> m(v.data(), dim);
+  TestType ref = m.det();
+  mmm::Matrix<TestType> copy = m;
+  EXPECT_FLOAT_EQ(std::move(copy).det(), ref);
+  EXPECT_FLOAT_EQ(m.detInplace(), ref);
+}
+
+TEST_F(MatrixIntTest, DetRvalueInt) {
+  // Too large for in place elimination, falls back to the copying engines
+  mmm::Matrix<TestType> big(v.data(), dim);
+  mmm::Matrix<TestType> copy = big;
+  EXPECT_TRUE(std::move(copy).detBig() == big.detBig());
+
+  std::ranges::transform(v, v.begin(), [](auto x) { return x % 7 - 3; });
+  mmm::Matrix<TestType> m(v.data(), dim);
+  auto ref = m.detBig();
+  EXPECT_TRUE(mmm::Matrix<TestType>(m).detBig() == ref);
+  EXPECT_TRUE(m.detBigInplace() == ref);
+}
+
+TEST(Matrix, DetExactLongLong) {
+  std::vector<long long> v3 = {3037000499, 12345, -7, 0, 3037000493,
+                               11,         0,     0, 1};
+  mmm::Matrix<long long> m3(v3.data(), 3);
+  EXPECT_EQ(m3.det(), 3037000499ll * 3037000493ll);
+}
+
+TEST(Matrix, DetOverflowInt) {
+  std::vector<int> v3 = {100000, 0, 0, 0, 100000, 0, 0, 0, 100000};
+  mmm::Matrix<int> m3(v3.data(), 3);
+  EXPECT_THROW(m3.det(), std::overflow_error);
+}
+
+TEST(Matrix, DetBigInt) {
+  constexpr int diag = 1000000;
+  std::vector<int> v(16, 0);
+  for (size_t i = 0; i < 4; ++i)
+    v[i * 4 + i] = diag;
+  v[1] = 7;
+  mmm::Matrix<int> m(v.data(), 4);
+  EXPECT_EQ(m.detBig().toString(), "1" + std::string(24, '0'));
+  EXPECT_THROW(m.det(), std::overflow_error);
+}
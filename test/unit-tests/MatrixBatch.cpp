@@ -0,0 +1,110 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <MatrixBatch.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+enum { MAX_DIM = 10, MAX_COUNT = 200 };
+
+class MatrixBatchTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    count = rand() % MAX_COUNT + 1;
+  }
+
+  template <typename T> mmm::MatrixBatch<T> random(int range) {
+    mmm::MatrixBatch<T> batch(count, dim);
+    for (size_t b = 0; b < count; ++b)
+      for (size_t i = 0; i < dim; ++i)
+        for (size_t j = 0; j < dim; ++j)
+          batch(b, i, j) =
+              static_cast<T>(int(rand() % (2 * range + 1)) - range);
+    return batch;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  size_t count;
+};
+
+TEST_F(MatrixBatchTest, SetAndGet) {
+  mmm::MatrixBatch<int> batch(count, dim);
+  mmm::Matrix<int> m(dim);
+  std::iota(m.begin(), m.end(), 1);
+  size_t b = rand() % count;
+  batch.set(b, m);
+  EXPECT_EQ(batch(b, dim - 1, 0), int(dim * (dim - 1) + 1));
+  auto back = batch.matrix(b);
+  EXPECT_TRUE(std::equal(m.begin(), m.end(), back.begin()));
+  EXPECT_THROW(batch.set(b, mmm::Matrix<int>(dim + 1)), std::runtime_error);
+}
+
+TEST_F(MatrixBatchTest, DoubleMatchesMatrix) {
+  auto batch = random<double>(10);
+  auto dets = batch.detBatch();
+  ASSERT_EQ(dets.size(), count);
+  for (size_t b = 0; b < count; ++b) {
+    double ref = batch.matrix(b).det();
+    EXPECT_NEAR(dets[b], ref, 1e-9 * std::max(1.0, std::abs(ref)));
+  }
+}
+
+TEST_F(MatrixBatchTest, FloatMatchesMatrix) {
+  auto batch = random<float>(4);
+  auto dets = batch.detBatch();
+  for (size_t b = 0; b < count; ++b) {
+    float ref = batch.matrix(b).det();
+    EXPECT_NEAR(dets[b], ref, 1e-3f * std::max(1.0f, std::abs(ref)));
+  }
+}
+
+TEST_F(MatrixBatchTest, IntegralExact) {
+  auto batch = random<long long>(10);
+  auto dets = batch.detBatch();
+  for (size_t b = 0; b < count; ++b)
+    EXPECT_EQ(dets[b], batch.matrix(b).det());
+}
+
+TEST_F(MatrixBatchTest, SingularLanes) {
+  auto batch = random<double>(10);
+  for (size_t b = 0; b < count; b += 2)
+    for (size_t i = 0; i < dim; ++i)
+      batch(b, i, dim / 2) = 0;
+  auto dets = batch.detBatch();
+  for (size_t b = 0; b < count; b += 2)
+    EXPECT_EQ(dets[b], 0);
+}
+
+TEST_F(MatrixBatchTest, Parallel) {
+  auto batch = random<double>(10);
+  mmm::ThreadPool pool(3);
+  mmm::DetPolicy policy;
+  policy.pool = &pool;
+  policy.minParallelDim = 1;
+  auto par = batch.detBatch(policy);
+  auto seq = batch.detBatch();
+  for (size_t b = 0; b < count; ++b)
+    EXPECT_EQ(par[b], seq[b]);
+}
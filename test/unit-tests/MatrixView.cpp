@@ -0,0 +1,215 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <MatrixView.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 40, MAX_PAD = 5 };
+
+class MatrixViewTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    ld = dim + rand() % MAX_PAD;
+    buf.resize(dim * ld);
+    std::ranges::generate(buf, [this] { return int(rand() % 21) - 10; });
+  }
+
+  // Dense copy of view elements without padding
+  template <typename T> std::vector<T> dense(mmm::MatrixView<T> v) {
+    std::vector<T> res;
+    for (size_t i = 0; i < v.dim(); ++i)
+      for (size_t j = 0; j < v.dim(); ++j)
+        res.push_back(v(i, j));
+    return res;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  size_t ld;
+  std::vector<int> buf;
+};
+
+TEST_F(MatrixViewTest, SharesMemory) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  v(dim - 1, 0) = 42;
+  EXPECT_EQ(buf[(dim - 1) * ld], 42);
+  EXPECT_EQ(v.data(), buf.data());
+  EXPECT_EQ(v.contiguous(), ld == dim);
+  EXPECT_THROW(mmm::MatrixView<int>(buf.data(), ld + 1, ld),
+               std::runtime_error);
+}
+
+TEST_F(MatrixViewTest, RowAndTrace) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  size_t i = rand() % dim;
+  auto row = v.row(i);
+  EXPECT_TRUE(std::equal(row.begin(), row.end(), buf.begin() + i * ld));
+
+  auto trace = v.trace();
+  for (size_t k = 0; k < dim; ++k)
+    EXPECT_EQ(trace[k], buf[k * ld + k]);
+
+  v.row(i) = 7;
+  EXPECT_EQ(buf[i * ld + dim - 1], 7);
+}
+
+TEST_F(MatrixViewTest, Block) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  size_t i = rand() % dim;
+  size_t j = rand() % dim;
+  size_t n = std::min(dim - i, dim - j);
+  auto b = v.block(i, j, n);
+  EXPECT_EQ(b.dim(), n);
+  EXPECT_EQ(b.ld(), ld);
+  EXPECT_EQ(b(n - 1, n - 1), v(i + n - 1, j + n - 1));
+  EXPECT_EQ(b.trace()[0], v(i, j));
+  EXPECT_THROW(v.block(i, j, n + 1), std::out_of_range);
+}
+
+TEST_F(MatrixViewTest, IntegralDetMatchesMatrix) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  auto copy = buf;
+  auto d = dense(v);
+  mmm::Matrix<int> m(d.begin(), dim);
+  EXPECT_TRUE(v.detBig() == m.detBig());
+  EXPECT_EQ(buf, copy);
+
+  size_t n = std::max<size_t>(1, dim / 2);
+  auto b = v.block(dim - n, dim - n, n);
+  auto db = dense(b);
+  EXPECT_TRUE(b.detBig() == mmm::Matrix<int>(db.begin(), n).detBig());
+}
+
+TEST_F(MatrixViewTest, FloatingDetMatchesMatrix) {
+  std::vector<double> fbuf(buf.begin(), buf.end());
+  mmm::MatrixView<double> v(fbuf.data(), dim, ld);
+  auto copy = fbuf;
+  auto d = dense(v);
+  double ref = mmm::Matrix<double>(d.begin(), dim).det();
+  EXPECT_NEAR(v.det(), ref, 1e-9 * std::max(1.0, std::abs(ref)));
+  EXPECT_EQ(fbuf, copy);
+}
+
+TEST_F(MatrixViewTest, SlogdetMatchesDet) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  auto d = dense(v);
+  double ref = mmm::Matrix<double>(d.begin(), dim).det();
+  auto [sign, logAbs] = v.slogdet();
+  if (std::abs(ref) < 1e-6) {
+    EXPECT_LT(logAbs, std::log(1e-3));
+  } else {
+    EXPECT_EQ(sign, ref < 0 ? -1 : 1);
+    EXPECT_NEAR(logAbs, std::log(std::abs(ref)), 1e-9);
+  }
+
+  // Huge diagonal overflows det(), but not slogdet(), even in place
+  mmm::Matrix<double> big(dim + 40);
+  std::fill(big.begin(), big.end(), 0.0);
+  for (size_t i = 0; i < big.dim(); ++i)
+    big(i, i) = i % 2 ? -1e300 : 1e300;
+  EXPECT_TRUE(std::isinf(big.det()));
+  auto res = std::move(big).slogdet();
+  EXPECT_EQ(res.sign, (dim + 40) / 2 % 2 ? -1 : 1);
+  EXPECT_NEAR(res.logAbs / ((dim + 40) * std::log(1e300)), 1.0, 1e-12);
+}
+
+TEST_F(MatrixViewTest, MixedWithinEstimate) {
+  // Diagonally dominant, so float LU is accurate
+  size_t n = dim + 100;
+  mmm::Matrix<double> m(n);
+  std::uniform_real_distribution<double> dist(-1, 1);
+  std::ranges::generate(m, [this, &dist, n] { return dist(rand) / n; });
+  for (size_t i = 0; i < n; ++i)
+    m(i, i) += i % 2 ? -2.0 : 2.0;
+
+  double ref = m.det();
+  auto res = m.detMixed();
+  EXPECT_FALSE(res.promoted);
+  EXPECT_GT(res.error, 0);
+  EXPECT_LE(std::abs(res.det / ref - 1), res.error);
+
+  // Nothing passes the tolerance in float, so double LU answers
+  auto exact = m.detMixed({}, 1e-12);
+  EXPECT_TRUE(exact.promoted);
+  EXPECT_NEAR(exact.det / ref, 1.0, 1e-12);
+}
+
+TEST_F(MatrixViewTest, MixedScalesOutOfFloatRange) {
+  mmm::Matrix<double> m(3);
+  std::fill(m.begin(), m.end(), 0.0);
+  m(0, 1) = 1e100;
+  m(1, 0) = 1e100;
+  m(2, 2) = 1e95 * (rand() % 10 + 1);
+  auto res = m.detMixed();
+  EXPECT_FALSE(res.promoted);
+  EXPECT_NEAR(res.det / m.det(), 1.0, 1e-6);
+
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  auto d = dense(v);
+  double ref = mmm::Matrix<double>(d.begin(), dim).det();
+  auto ires = v.detMixed({}, 1e-12);
+  EXPECT_NEAR(ires.det, ref, 1e-9 * std::max(1.0, std::abs(ref)));
+}
+
+TEST_F(MatrixViewTest, MatrixRoundTrip) {
+  mmm::Matrix<int> m(dim);
+  std::iota(m.begin(), m.end(), 0);
+  auto v = m.view();
+  EXPECT_EQ(v.data(), m.begin());
+  EXPECT_TRUE(v.contiguous());
+
+  mmm::MatrixView<int> padded(buf.data(), dim, ld);
+  mmm::Matrix<int> owned(padded);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j)
+      EXPECT_EQ(owned(i, j), padded(i, j));
+}
+
+TEST_F(MatrixViewTest, InplaceDetStaysInsideView) {
+  size_t n = std::max<size_t>(1, dim - rand() % dim);
+  std::vector<double> fbuf(buf.begin(), buf.end());
+  mmm::MatrixView<double> fv(fbuf.data(), dim, ld);
+  auto fb = fv.block(dim - n, 0, n);
+  auto fd = dense(fb);
+  double ref = mmm::Matrix<double>(fd.begin(), n).det();
+  auto fcopy = fbuf;
+  EXPECT_NEAR(fb.detInplace(), ref, 1e-9 * std::max(1.0, std::abs(ref)));
+
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  auto b = v.block(dim - n, 0, n);
+  auto d = dense(b);
+  auto copy = buf;
+  EXPECT_TRUE(b.detBigInplace() == mmm::Matrix<int>(d.begin(), n).detBig());
+
+  // Rows above the block and columns right of it are left alone
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < ld; ++j)
+      if (i < dim - n || j >= n) {
+        EXPECT_EQ(fbuf[i * ld + j], fcopy[i * ld + j]);
+        EXPECT_EQ(buf[i * ld + j], copy[i * ld + j]);
+      }
+}
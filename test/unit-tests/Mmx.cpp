@@ -0,0 +1,117 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Mmx.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+enum { MAX_DIM = 100, MAX_PAD = 5 };
+
+class MmxTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    ld = dim + rand() % MAX_PAD;
+    buf.resize(dim * ld);
+    std::ranges::generate(buf, [this] { return int(rand() % 21) - 10; });
+    path = std::filesystem::temp_directory_path() /
+           ("hwmx-mmx-" + std::to_string(rand()));
+  }
+
+  void TearDown() override { std::filesystem::remove(path); }
+
+  template <typename T> void write(const mmm::MatrixView<T> &m) {
+    std::ofstream os(path, std::ios::binary);
+    mmm::writeMmx(os, m);
+  }
+
+  std::string contents() {
+    std::ifstream is(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), {});
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  size_t ld;
+  std::vector<int> buf;
+  std::filesystem::path path;
+};
+
+TEST_F(MmxTest, RoundTrip) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  write(v);
+
+  mmm::MappedMatrix<int> m(path.string());
+  EXPECT_TRUE(m.mapped());
+  EXPECT_EQ(m.dim(), dim);
+  EXPECT_TRUE(m.view().contiguous());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(m.view().data()) % mmm::mmx_align, 0);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j)
+      EXPECT_EQ(m.view()(i, j), v(i, j));
+  EXPECT_TRUE(m.view().detBig() == v.detBig());
+}
+
+TEST_F(MmxTest, InplaceDetKeepsFile) {
+  std::vector<double> fbuf(buf.begin(), buf.end());
+  mmm::MatrixView<double> v(fbuf.data(), dim, ld);
+  write(v);
+  auto before = contents();
+
+  double ref = v.det();
+  mmm::MappedMatrix<double> m(path.string());
+  EXPECT_NEAR(m.view().detInplace(), ref, 1e-9 * std::max(1.0, std::abs(ref)));
+  EXPECT_EQ(contents(), before);
+}
+
+TEST_F(MmxTest, DetectsFormat) {
+  mmm::Matrix<float> m(dim);
+  std::ostringstream oss;
+  mmm::writeMmx(oss, m);
+  EXPECT_TRUE(mmm::isMmx(oss.str()));
+  EXPECT_EQ(oss.str().size(), sizeof(mmm::MmxHeader) + dim * dim * 4);
+  EXPECT_FALSE(mmm::isMmx("2 1 2 3 4"));
+  EXPECT_FALSE(mmm::isMmx("MM"));
+}
+
+TEST_F(MmxTest, RejectsMismatch) {
+  mmm::MatrixView<int> v(buf.data(), dim, ld);
+  write(v);
+  EXPECT_THROW(mmm::MappedMatrix<float>(path.string()), std::runtime_error);
+  EXPECT_THROW(mmm::MappedMatrix<long long>(path.string()),
+               std::runtime_error);
+  EXPECT_THROW(mmm::MappedMatrix<unsigned>(path.string()),
+               std::runtime_error);
+
+  auto bytes = contents();
+  std::filesystem::resize_file(path, bytes.size() - 1);
+  EXPECT_THROW(mmm::MappedMatrix<int>(path.string()), std::runtime_error);
+
+  bytes[4] = 2; // version
+  std::ofstream(path, std::ios::binary) << bytes;
+  EXPECT_THROW(mmm::MappedMatrix<int>(path.string()), std::runtime_error);
+
+  std::ofstream(path, std::ios::binary) << "2 1 2 3 4";
+  EXPECT_THROW(mmm::MappedMatrix<int>(path.string()), std::runtime_error);
+}
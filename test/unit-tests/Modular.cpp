@@ -0,0 +1,107 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Bareiss.hpp>
+#include <Modular.hpp>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 24 };
+
+class ModularTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    v.resize(dim * dim);
+    std::ranges::generate(v, [this] { return int(rand() % 21) - 10; });
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::vector<int> v;
+};
+
+TEST_F(ModularTest, Montgomery) {
+  auto p = mmm::modularPrimes(1)[0];
+  mmm::Montgomery m(p);
+  for (int i = 0; i < 1000; ++i) {
+    uint32_t a = rand() % p, b = rand() % p;
+    auto prod = m.fromMont(m.mul(m.toMont(a), m.toMont(b)));
+    EXPECT_EQ(prod, uint64_t{a} * b % p);
+    if (a)
+      EXPECT_EQ(m.fromMont(m.mul(m.inv(m.toMont(a)), m.toMont(a))), 1);
+  }
+  EXPECT_EQ(m.fromMont(m.fromInt(-1)), p - 1);
+  EXPECT_EQ(m.fromMont(m.fromInt(-static_cast<long long>(p))), 0);
+}
+
+TEST_F(ModularTest, Primes) {
+  EXPECT_TRUE(mmm::isPrime32(2147483647));
+  EXPECT_FALSE(mmm::isPrime32(2147483649u));
+  EXPECT_FALSE(mmm::isPrime32(3215031751u)); // strong pseudoprime to 2,3,5,7
+  auto primes = mmm::modularPrimes(10);
+  EXPECT_EQ(primes.size(), 10);
+  EXPECT_TRUE(std::ranges::is_sorted(primes, std::greater{}));
+  for (auto p : primes)
+    EXPECT_GT(p, 1u << 30);
+}
+
+TEST_F(ModularTest, MatchesBareiss) {
+  size_t n = std::min<size_t>(dim, 12);
+  auto expect = mmm::bareissDet(v.data(), n, dim);
+  ASSERT_TRUE(expect.has_value());
+  EXPECT_EQ(mmm::detModular(v.data(), n, dim), mmm::BigInt(*expect));
+}
+
+TEST_F(ModularTest, Singular) {
+  for (size_t j = 0; j < dim; ++j)
+    v[j] = 0;
+  EXPECT_TRUE(mmm::detModular(v.data(), dim, dim).isZero());
+}
+
+TEST_F(ModularTest, HugeTriangular) {
+  constexpr long long diag = 1000000007;
+  std::vector<long long> m(dim * dim, 0);
+  for (size_t i = 0; i < dim; ++i) {
+    m[i * dim + i] = (i % 2 ? -1 : 1) * diag;
+    for (size_t j = i + 1; j < dim; ++j)
+      m[i * dim + j] = v[i * dim + j] * 123456789ll;
+  }
+
+  // Reverse row order with dim / 2 swaps
+  for (size_t i = 0; i < dim / 2; ++i)
+    for (size_t j = 0; j < dim; ++j)
+      std::swap(m[i * dim + j], m[(dim - 1 - i) * dim + j]);
+
+  mmm::BigInt mag(1);
+  for (size_t i = 0; i < dim; ++i)
+    mag.mulAdd(diag, 0);
+  size_t negDiag = dim / 2, swaps = dim / 2;
+  bool neg = (negDiag + swaps) % 2;
+  EXPECT_EQ(mmm::detModular(m.data(), dim, dim), neg ? -mag : mag);
+}
+
+TEST_F(ModularTest, ParallelMatchesSequential) {
+  std::ranges::for_each(v, [](int &x) { x *= 1000003; });
+  auto expect = mmm::detModular(v.data(), dim, dim);
+  mmm::ThreadPool pool(rand() % 4 + 1);
+  EXPECT_EQ(mmm::detModular(v.data(), dim, dim, &pool), expect);
+}
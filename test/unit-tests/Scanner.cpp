@@ -19,6 +19,8 @@
 #include <Scanner.hpp>
 
 #include <gtest/gtest.h>
+#include <iomanip>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 
@@ -91,3 +93,127 @@ TEST(Scanner, ExpectedFloatInputFailure1) {
   std::istringstream iss{"1 1.f"};
   EXPECT_THROW(auto m = mmm::magicScanner<float>(iss), std::ios_base::failure);
 }
+
+TEST(Scanner, ExplicitSignsAndSpaces) {
+  auto m = mmm::magicScanner<int>("\t+2\n\n  -1 +2\r\n3\v\f             -4 ");
+  EXPECT_EQ(m.dim(), 2);
+  EXPECT_EQ(m(0, 0), -1);
+  EXPECT_EQ(m(0, 1), 2);
+  EXPECT_EQ(m(1, 1), -4);
+}
+
+TEST(Scanner, ExpectedFloatInputFailure2) {
+  for (auto *text : {"1 inf", "1 nan", "1 +-1", "1 ++1", "1 -", "1 1e",
+                     "1 0x1p3", "1 1\x01", "1 1e99999"})
+    EXPECT_THROW(auto m = mmm::magicScanner<double>(text),
+                 std::ios_base::failure)
+        << text;
+}
+
+TEST(Scanner, ExpectedIntInputFailure4) {
+  for (auto *text : {"2 1 2 3", "1 99999999999", "1 \x01 1", "99999999999 1"})
+    EXPECT_THROW(auto m = mmm::magicScanner<int>(text), std::ios_base::failure)
+        << text;
+}
+
+TEST(Scanner, StreamIsConsumed) {
+  std::istringstream iss{"1 -.5 trailing"};
+  auto m = mmm::magicScanner<double>(iss);
+  EXPECT_DOUBLE_EQ(m(0, 0), -0.5);
+  EXPECT_TRUE(iss.eof());
+}
+
+TEST(Scanner, RandomRoundTrip) {
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim = rand() % 64 + 1;
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  std::vector<double> v(dim * dim);
+  std::ranges::generate(v, [&] { return dist(rand); });
+
+  std::ostringstream oss;
+  oss << std::setprecision(17) << dim;
+  for (auto x : v)
+    oss << (rand() % 2 ? "\n" : std::string(rand() % 40 + 1, ' ')) << x;
+
+  auto m = mmm::magicScanner<double>(oss.str());
+  EXPECT_TRUE(std::equal(m.begin(), m.end(), v.begin()));
+}
+
+TEST(Scanner, ElementIndexInError) {
+  try {
+    auto m = mmm::magicScanner<int>("2 1 2 x 4");
+    FAIL() << "Expected ScanError";
+  } catch (const mmm::ScanError &e) {
+    EXPECT_EQ(e.element(), 2);
+  }
+}
+
+class ScannerParallelTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    v.resize(dim * dim);
+    std::ranges::generate(v, [this] { return int(rand()) - (1 << 30); });
+    std::ostringstream oss;
+    oss << dim;
+    for (auto x : v)
+      oss << (rand() % 2 ? "\n" : std::string(rand() % 20 + 1, ' ')) << x;
+    text = oss.str();
+  }
+
+  // Position of first character of element i in text
+  size_t elementPos(size_t i) {
+    auto sep = [](char c) { return std::isspace(c); };
+    auto it = std::ranges::find_if(text, sep);
+    for (size_t k = 0; k <= i; ++k) {
+      it = std::find_if_not(it, text.end(), sep);
+      if (k < i)
+        it = std::find_if(it, text.end(), sep);
+    }
+    return it - text.begin();
+  }
+
+  enum { MAX_DIM = 100 };
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::vector<int> v;
+  std::string text;
+  mmm::ThreadPool pool{3};
+  mmm::ScanPolicy policy{.pool = &pool, .chunkBytes = 64};
+};
+
+TEST_F(ScannerParallelTest, MatchesSequential) {
+  auto m = mmm::magicScanner<int>(text + " trailing garbage", policy);
+  EXPECT_TRUE(std::equal(m.begin(), m.end(), v.begin()));
+
+  auto own =
+      mmm::magicScanner<long long>(text, {.threads = 4, .chunkBytes = 1});
+  EXPECT_TRUE(std::equal(own.begin(), own.end(), v.begin()));
+}
+
+TEST_F(ScannerParallelTest, ReportsFirstBadElement) {
+  size_t bad = rand() % v.size();
+  text.insert(elementPos(bad), "x");
+  if (bad + 1 < v.size())
+    text.insert(elementPos(v.size() - 1), ".");
+
+  for (auto p : {policy, mmm::ScanPolicy{}})
+    try {
+      auto m = mmm::magicScanner<int>(text, p);
+      FAIL() << "Expected ScanError";
+    } catch (const mmm::ScanError &e) {
+      EXPECT_EQ(e.element(), bad);
+    }
+}
+
+TEST_F(ScannerParallelTest, ReportsMissingElement) {
+  size_t missing = rand() % v.size();
+  text.resize(elementPos(missing));
+  try {
+    auto m = mmm::magicScanner<int>(text, policy);
+    FAIL() << "Expected ScanError";
+  } catch (const mmm::ScanError &e) {
+    EXPECT_EQ(e.element(), missing);
+  }
+}
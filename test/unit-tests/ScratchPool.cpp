@@ -0,0 +1,125 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <ScratchPool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// Counts every allocation of this binary to check det() doesn't allocate
+static std::atomic<size_t> new_calls = 0;
+
+void *operator new(size_t bytes) {
+  ++new_calls;
+  if (void *p = std::malloc(bytes ? bytes : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new(size_t bytes, std::align_val_t align) {
+  ++new_calls;
+  size_t a = static_cast<size_t>(align);
+  if (void *p = std::aligned_alloc(a, (bytes + a - 1) / a * a))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+enum { MAX_DIM = 300 };
+
+class ScratchPoolTest : public ::testing::Test {
+protected:
+  void TearDown() override { pool.trim(); }
+
+  std::mt19937 rand{std::random_device{}()};
+  mmm::ScratchPool &pool = mmm::ScratchPool::local();
+};
+
+TEST_F(ScratchPoolTest, ReusesReleasedBuffers) {
+  size_t bytes = rand() % 100000 + 1;
+  auto before = pool.stats();
+  auto *p = pool.acquire(bytes);
+  pool.release(p, bytes);
+  EXPECT_GT(pool.stats().cachedBytes, before.cachedBytes);
+
+  auto *q = pool.acquire(bytes);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(pool.stats().acquires, before.acquires + 2);
+  EXPECT_EQ(pool.stats().allocations, before.allocations + 1);
+  pool.release(q, bytes);
+}
+
+TEST_F(ScratchPoolTest, SizeClasses) {
+  auto *p = pool.acquire(100);
+  pool.release(p, 100);
+  EXPECT_EQ(pool.acquire(128), p);
+  pool.release(p, 128);
+  auto *q = pool.acquire(129);
+  EXPECT_NE(q, p);
+  pool.release(q, 129);
+  EXPECT_EQ(pool.stats().cachedBytes, 128 + 256);
+}
+
+TEST_F(ScratchPoolTest, LargeBuffersBypassPool) {
+  size_t bytes = mmm::ScratchPool::max_pooled_bytes + 1;
+  auto before = pool.stats();
+  auto *p = pool.acquire(bytes);
+  p[bytes - 1] = std::byte{1};
+  pool.release(p, bytes);
+  EXPECT_EQ(pool.stats().cachedBytes, before.cachedBytes);
+  EXPECT_EQ(pool.stats().allocations, before.allocations + 1);
+}
+
+TEST_F(ScratchPoolTest, ScratchVector) {
+  size_t n = rand() % 1000 + 1;
+  double *first;
+  {
+    mmm::ScratchVector<double> v(n);
+    first = v.begin();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0);
+  }
+
+  size_t allocations = mmm::ScratchPool::totalAllocations();
+  mmm::ScratchVector<double> v(n);
+  EXPECT_EQ(v.begin(), first);
+  EXPECT_EQ(mmm::ScratchPool::totalAllocations(), allocations);
+}
+
+TEST_F(ScratchPoolTest, DetSteadyStateDoesntAllocate) {
+  size_t dim = rand() % MAX_DIM + 1;
+  mmm::Matrix<double> m(dim);
+  std::uniform_real_distribution<double> dist(-1, 1);
+  std::ranges::generate(m, [this, &dist] { return dist(rand); });
+
+  double first = m.det();
+  size_t calls = new_calls;
+  double second = m.det();
+  EXPECT_EQ(new_calls, calls) << "dim = " << dim;
+  EXPECT_EQ(first, second);
+}
@@ -0,0 +1,126 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Server.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum { MAX_DIM = 12, MAX_CLIENTS = 8 };
+
+class ServerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path = (std::filesystem::temp_directory_path() /
+            ("hwmx-server-" + std::to_string(rand())))
+               .string();
+    server = std::make_unique<mmm::DetServer>(path, 2);
+    runner = std::thread([this] { server->run(); });
+  }
+
+  void TearDown() override {
+    server->stop();
+    runner.join();
+    server.reset();
+    EXPECT_FALSE(std::filesystem::exists(path));
+  }
+
+  // Random integral text matrix and its exact determinant
+  std::pair<std::string, std::string> randomMatrix() {
+    size_t dim = rand() % MAX_DIM + 1;
+    mmm::Matrix<int> m(dim);
+    std::ranges::generate(m, [this] { return int(rand() % 21) - 10; });
+    std::ostringstream oss;
+    oss << dim;
+    for (auto x : m)
+      oss << ' ' << x;
+    return {oss.str(), m.detBig().toString()};
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  std::string path;
+  std::unique_ptr<mmm::DetServer> server;
+  std::thread runner;
+};
+
+TEST_F(ServerTest, TextRequests) {
+  mmm::DetClient client(path);
+  auto [text, det] = randomMatrix();
+  EXPECT_EQ(client.det(mmm::WireType::Int32, text), det);
+  EXPECT_EQ(client.det(mmm::WireType::Int64, text), det);
+  EXPECT_EQ(client.det(mmm::WireType::Float64, "2 0.5 1 1 3"), "0.5");
+  EXPECT_EQ(client.det(mmm::WireType::Float32, "1 0.1"), "0.1");
+}
+
+TEST_F(ServerTest, MmxRequest) {
+  mmm::Matrix<double> m(3);
+  std::ranges::copy(std::vector<double>{2, -3, 1, 2, 0, -1, 1, 4, 5},
+                    m.begin());
+  std::ostringstream oss;
+  mmm::writeMmx(oss, m);
+
+  mmm::DetClient client(path);
+  client.send(7, mmm::WireFormat::Mmx, mmm::WireType::Float64, oss.str());
+  auto reply = client.receive();
+  EXPECT_EQ(reply.id, 7);
+  EXPECT_TRUE(reply.ok);
+  EXPECT_EQ(std::stod(reply.text), 49.0);
+
+  client.send(8, mmm::WireFormat::Mmx, mmm::WireType::Int32, oss.str());
+  EXPECT_FALSE(client.receive().ok);
+}
+
+TEST_F(ServerTest, ErrorsKeepConnection) {
+  mmm::DetClient client(path);
+  EXPECT_THROW(client.det(mmm::WireType::Int32, "2 1 x 3 4"),
+               std::runtime_error);
+  EXPECT_THROW(client.det(mmm::WireType::Int32, "0"), std::runtime_error);
+  EXPECT_EQ(client.det(mmm::WireType::Int32, "1 5"), "5");
+}
+
+TEST_F(ServerTest, PipelinedConcurrentClients) {
+  size_t clients = rand() % MAX_CLIENTS + 1;
+  std::vector<std::pair<std::string, std::string>> cases(rand() % 100 + 1);
+  std::ranges::generate(cases, [this] { return randomMatrix(); });
+
+  std::vector<std::thread> threads;
+  std::vector<size_t> correct(clients, 0);
+  for (size_t c = 0; c < clients; ++c)
+    threads.emplace_back([this, c, &cases, &correct] {
+      mmm::DetClient client(path);
+      for (size_t i = 0; i < cases.size(); ++i)
+        client.send(i, mmm::WireFormat::Text, mmm::WireType::Int32,
+                    cases[i].first);
+      for (size_t i = 0; i < cases.size(); ++i) {
+        auto reply = client.receive();
+        correct[c] +=
+            reply.ok && reply.id == i && reply.text == cases[i].second;
+      }
+    });
+  for (auto &t : threads)
+    t.join();
+
+  for (auto n : correct)
+    EXPECT_EQ(n, cases.size());
+}
@@ -248,3 +248,43 @@ TEST_F(SliceFloatTest, FloatMulSlice) {
       EXPECT_FLOAT_EQ(mul[i], v[start + i * stride] * v[0]);
   }
 }
+
+TEST_F(SliceIntTest, FmaSubSliceInt) {
+  constexpr size_t start = 0;
+
+  for (const auto stride : std::views::iota(1u, size)) {
+    std::vector<TestType> vtmp = v;
+    std::vector<TestType> other(size, 3);
+    size_t sliceSize = size / stride + (size % stride != 0);
+    Slice s(vtmp.data(), size, start, stride, sliceSize);
+    Slice o(other.data(), size, start, stride, sliceSize);
+    s.fmaSub(2, o);
+    for (auto i : std::views::iota(0u, sliceSize))
+      EXPECT_EQ(s[i], v[start + i * stride] - 6);
+  }
+}
+
+TEST_F(SliceFloatTest, FmaSubSliceFloat) {
+  constexpr size_t start = 0;
+
+  for (const auto stride : std::views::iota(1u, size)) {
+    std::vector<TestType> vtmp = v;
+    std::vector<TestType> other = v;
+    std::ranges::reverse(other);
+    size_t sliceSize = size / stride + (size % stride != 0);
+    Slice s(vtmp.data(), size, start, stride, sliceSize);
+    Slice o(other.data(), size, start, stride, sliceSize);
+    s.fmaSub(0.5f, o);
+    for (auto i : std::views::iota(0u, sliceSize))
+      EXPECT_FLOAT_EQ(s[i],
+                      v[start + i * stride] - 0.5f * other[start + i * stride]);
+  }
+}
+
+TEST_F(SliceFloatTest, FmaSubFailFloat) {
+  if (size < 2)
+    return;
+  Slice s(v.data(), size, 0, 1, size);
+  Slice o(v.data(), size, 0, 1, size - 1);
+  EXPECT_THROW(s.fmaSub(1.0f, o), std::runtime_error);
+}
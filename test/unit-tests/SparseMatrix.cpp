@@ -0,0 +1,150 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <SparseMatrix.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 60 };
+
+class SparseMatrixTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    // About 3 off-diagonal nonzeros per row, some of them duplicated
+    for (size_t i = 0; i < dim; ++i) {
+      triplets.push_back({i, i, int(rand() % 9) + 1});
+      for (int k = 0; k < 3; ++k)
+        triplets.push_back({i, rand() % dim, int(rand() % 19) - 9});
+    }
+    std::ranges::shuffle(triplets, rand);
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::vector<mmm::Triplet<int>> triplets;
+};
+
+TEST_F(SparseMatrixTest, FromTriplets) {
+  mmm::SparseMatrix<int> s(dim, triplets);
+  mmm::Matrix<int> ref(dim);
+  std::fill(ref.begin(), ref.end(), 0);
+  for (auto &t : triplets)
+    ref(t.row, t.col) += t.value;
+
+  size_t nnz = std::count_if(ref.begin(), ref.end(), [](int x) { return x; });
+  EXPECT_EQ(s.nnz(), nnz);
+  auto dense = s.toDense();
+  EXPECT_TRUE(std::equal(dense.begin(), dense.end(), ref.begin()));
+  size_t i = rand() % dim, j = rand() % dim;
+  EXPECT_EQ(s(i, j), ref(i, j));
+
+  for (size_t r = 0; r < dim; ++r)
+    EXPECT_TRUE(std::is_sorted(s.colIdx().begin() + s.rowPtr()[r],
+                               s.colIdx().begin() + s.rowPtr()[r + 1]));
+
+  // Opposite duplicates cancel out
+  mmm::SparseMatrix<int> c(2, {{0, 1, 5}, {1, 0, 2}, {0, 1, -5}});
+  EXPECT_EQ(c.nnz(), 1);
+  EXPECT_THROW(mmm::SparseMatrix<int>(2, {{2, 0, 1}}), std::out_of_range);
+}
+
+TEST_F(SparseMatrixTest, DetMatchesDense) {
+  mmm::SparseMatrix<int> s(dim, triplets);
+  auto dense = s.toDense();
+  EXPECT_TRUE(s.detBig() == dense.detBig());
+  EXPECT_TRUE(s.detBig({.threads = 3}) == dense.detBig());
+
+  mmm::Matrix<double> fdense(dense);
+  mmm::SparseMatrix<double> f(fdense.view());
+  EXPECT_EQ(f.nnz(), s.nnz());
+  double ref = fdense.det();
+  EXPECT_NEAR(f.det(), ref, 1e-9 * std::max(1.0, std::abs(ref)));
+}
+
+TEST_F(SparseMatrixTest, SingularAndPermutation) {
+  // Empty row
+  triplets.erase(std::remove_if(triplets.begin(), triplets.end(),
+                                [](auto &t) { return t.row == 0; }),
+                 triplets.end());
+  EXPECT_TRUE(mmm::SparseMatrix<int>(dim, triplets).detBig().isZero());
+  EXPECT_EQ(mmm::SparseMatrix<double>(dim, std::vector<mmm::Triplet<double>>{})
+                .det(),
+            0.0);
+
+  // Numerically singular: two equal rows
+  mmm::SparseMatrix<double> twice(3, {{0, 0, 1}, {0, 2, 2}, {1, 0, 1},
+                                      {1, 2, 2}, {2, 1, 3}});
+  EXPECT_EQ(twice.det(), 0.0);
+
+  std::vector<size_t> perm(dim);
+  std::iota(perm.begin(), perm.end(), size_t{0});
+  std::ranges::shuffle(perm, rand);
+  std::vector<mmm::Triplet<int>> p;
+  for (size_t i = 0; i < dim; ++i)
+    p.push_back({i, perm[i], 1});
+  mmm::SparseMatrix<int> s(dim, p);
+  EXPECT_EQ(std::abs(s.det()), 1);
+  EXPECT_EQ(s.det(), s.toDense().det());
+}
+
+TEST_F(SparseMatrixTest, GridLaplacianSlogdet) {
+  // 5-point Laplacian on k x k grid, det is product of its known eigenvalues
+  size_t k = rand() % 20 + 30, n = k * k;
+  std::vector<mmm::Triplet<double>> t;
+  for (size_t i = 0; i < k; ++i)
+    for (size_t j = 0; j < k; ++j) {
+      size_t v = i * k + j;
+      t.push_back({v, v, 4});
+      if (i + 1 < k) {
+        t.push_back({v, v + k, -1});
+        t.push_back({v + k, v, -1});
+      }
+      if (j + 1 < k) {
+        t.push_back({v, v + 1, -1});
+        t.push_back({v + 1, v, -1});
+      }
+    }
+  mmm::SparseMatrix<double> s(n, t);
+
+  double expect = 0;
+  double h = std::numbers::pi / static_cast<double>(k + 1);
+  for (size_t i = 1; i <= k; ++i)
+    for (size_t j = 1; j <= k; ++j)
+      expect += std::log(4 - 2 * std::cos(i * h) - 2 * std::cos(j * h));
+
+  auto [sign, logAbs] = s.slogdet();
+  EXPECT_EQ(sign, 1);
+  EXPECT_NEAR(logAbs / expect, 1.0, 1e-10);
+
+  // Ordering keeps fill far below dense n^2 / 2
+  auto symbolic = mmm::analyzeSparse(n, s.rowPtr().data(), s.colIdx().data());
+  EXPECT_LT(symbolic.lnz, n * k);
+  auto order = symbolic.order;
+  std::ranges::sort(order);
+  for (size_t v = 0; v < n; ++v)
+    EXPECT_EQ(order[v], v);
+}
@@ -0,0 +1,130 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <LU.hpp>
+#include <Matrix.hpp>
+#include <StaticMatrix.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+using mmm::StaticMatrix;
+
+static_assert(StaticMatrix<int, 2>({1, 2, 3, 4}).det() == -2);
+static_assert(StaticMatrix<int, 3>({2, 0, 1, 1, 3, 2, 1, 1, 2}).det() == 6);
+static_assert(StaticMatrix<double, 4>({2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4, 0, 0,
+                                       0, 0, 5})
+                  .det() == 120);
+static_assert(StaticMatrix<double, 5>({0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 2,
+                                       0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 2})
+                  .det() == -8);
+
+class StaticMatrixTest : public ::testing::Test {
+protected:
+  template <typename T> std::vector<T> random(size_t n, int range) {
+    std::vector<T> v(n * n);
+    std::ranges::generate(v, [this, range] {
+      return static_cast<T>(int(rand() % (2 * range + 1)) - range);
+    });
+    return v;
+  }
+
+  template <size_t N> void checkIntegral() {
+    auto v = random<int>(N, 100);
+    StaticMatrix<int, N> m(v.begin());
+    auto ref = mmm::bareissDet(v.data(), N, N);
+    ASSERT_TRUE(ref);
+    auto res = m.detWide();
+    ASSERT_TRUE(res);
+    EXPECT_TRUE(*res == *ref) << "N = " << N;
+  }
+
+  template <size_t N> void checkFloating() {
+    auto v = random<double>(N, 10);
+    StaticMatrix<double, N> m(v.begin());
+    auto copy = v;
+    double ref = mmm::BlockedLU<double>(copy.data(), N, N).factorize().det();
+    EXPECT_NEAR(m.det(), ref, 1e-9 * std::max(1.0, std::abs(ref)))
+        << "N = " << N;
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+};
+
+TEST_F(StaticMatrixTest, IntegralMatchesBareiss) {
+  [this]<size_t... N>(std::index_sequence<N...>) {
+    (checkIntegral<N + 1>(), ...);
+  }(std::make_index_sequence<mmm::max_static_dim>{});
+}
+
+TEST_F(StaticMatrixTest, FloatingMatchesLU) {
+  [this]<size_t... N>(std::index_sequence<N...>) {
+    (checkFloating<N + 1>(), ...);
+  }(std::make_index_sequence<mmm::max_static_dim>{});
+}
+
+TEST_F(StaticMatrixTest, Singular) {
+  auto v = random<double>(6, 10);
+  for (size_t i = 0; i < 6; ++i)
+    v[i * 6 + 3] = 0;
+  EXPECT_EQ((StaticMatrix<double, 6>(v.begin()).det()), 0);
+  EXPECT_EQ((StaticMatrix<int, 3>({1, 2, 3, 2, 4, 6, 0, 1, 1}).det()), 0);
+}
+
+TEST_F(StaticMatrixTest, Overflow) {
+  constexpr long long big = std::numeric_limits<long long>::max() / 2;
+  StaticMatrix<long long, 2> m({big, 1, -1, big});
+  auto res = m.detWide();
+  ASSERT_TRUE(res);
+  EXPECT_TRUE(*res == mmm::Int128{big} * big + 1);
+  EXPECT_THROW(m.det(), std::overflow_error);
+
+  // Intermediate minors don't fit into 128 bits
+  std::vector<long long> v(64);
+  std::ranges::generate(v, [this] {
+    return static_cast<long long>(rand()) << 31 | rand();
+  });
+  EXPECT_FALSE((StaticMatrix<long long, 8>(v.begin()).detWide()));
+}
+
+TEST_F(StaticMatrixTest, MatrixDispatch) {
+  for (size_t n = 1; n <= mmm::max_static_dim; ++n) {
+    auto v = random<int>(n, 1000);
+    mmm::Matrix<int> m(v.begin(), n);
+    auto ref = mmm::detModular(v.data(), n, n);
+    EXPECT_TRUE(m.detBig() == ref);
+    if (auto small = ref.narrow<int>())
+      EXPECT_EQ(m.det(), *small);
+    else
+      EXPECT_THROW(m.det(), std::overflow_error);
+  }
+
+  // Large entries overflow 128-bit kernel and fall back to CRT engine
+  std::vector<long long> v(64);
+  std::ranges::generate(v, [this] {
+    return static_cast<long long>(rand()) << 31 | rand();
+  });
+  mmm::Matrix<long long> m(v.begin(), 8);
+  EXPECT_TRUE(m.detBig() == mmm::detModular(v.data(), 8, 8));
+}
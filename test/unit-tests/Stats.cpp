@@ -0,0 +1,120 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <Scanner.hpp>
+#include <Stats.hpp>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+enum { MAX_DIM = 100 };
+
+class StatsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dim = rand() % MAX_DIM + 1;
+    std::ostringstream oss;
+    oss << dim << '\n';
+    // No trailing space, so the whole text is consumed by elements
+    for (size_t i = 0; i < dim * dim; ++i)
+      oss << (i ? " " : "") << int(rand() % 21) - 10;
+    text = oss.str();
+    stats.enable();
+  }
+
+  void TearDown() override { stats.disable(); }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+  std::string text;
+  mmm::Stats &stats = mmm::Stats::global();
+};
+
+TEST_F(StatsTest, DisabledIsSilent) {
+  stats.disable();
+  auto m = mmm::magicScanner<double>(text);
+  { mmm::ScopedTimer timer(mmm::Phase::Output); }
+  EXPECT_EQ(stats.count(mmm::Counter::BytesParsed), 0);
+  EXPECT_EQ(stats.count(mmm::Counter::Matrices), 0);
+  EXPECT_EQ(stats.calls(mmm::Phase::Parse), 0);
+  EXPECT_EQ(stats.calls(mmm::Phase::Output), 0);
+}
+
+TEST_F(StatsTest, CountsParsing) {
+  auto m = mmm::magicScanner<int>(text);
+  EXPECT_EQ(stats.count(mmm::Counter::BytesParsed), text.size());
+  EXPECT_EQ(stats.count(mmm::Counter::Elements), dim * dim);
+  EXPECT_EQ(stats.count(mmm::Counter::Matrices), 1);
+  EXPECT_EQ(stats.calls(mmm::Phase::Parse), 1);
+
+  // Parallel path counts the same
+  mmm::ScanPolicy policy{.threads = 2, .chunkBytes = 64};
+  auto p = mmm::magicScanner<int>(text, policy);
+  EXPECT_EQ(stats.count(mmm::Counter::BytesParsed), 2 * text.size());
+  EXPECT_EQ(stats.count(mmm::Counter::Elements), 2 * dim * dim);
+}
+
+TEST_F(StatsTest, CountsElimination) {
+  auto m = mmm::magicScanner<double>(text);
+  (void)m.det();
+  EXPECT_EQ(stats.count(mmm::Counter::Determinants), 1);
+  EXPECT_EQ(stats.calls(mmm::Phase::Eliminate), 1);
+
+  // Rows in reverse order need pivoting
+  mmm::Matrix<double> r(64);
+  for (size_t i = 0; i < 64; ++i)
+    for (size_t j = 0; j < 64; ++j)
+      r(i, j) = i + j == 63 ? 1 : 0;
+  stats.reset();
+  EXPECT_EQ(std::abs(r.det()), 1);
+  EXPECT_GT(stats.count(mmm::Counter::Pivots), 0);
+  EXPECT_EQ(stats.calls(mmm::Phase::Copy), 1);
+}
+
+TEST_F(StatsTest, TimersFromThreads) {
+  std::thread t([] {
+    mmm::ScopedTimer timer(mmm::Phase::Output);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  });
+  {
+    mmm::ScopedTimer timer(mmm::Phase::Output);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  t.join();
+  EXPECT_EQ(stats.calls(mmm::Phase::Output), 2);
+  EXPECT_GE(stats.nanos(mmm::Phase::Output), 4'000'000);
+}
+
+TEST_F(StatsTest, Reports) {
+  auto m = mmm::magicScanner<int>(text);
+  std::ostringstream json, plain;
+  stats.report(json, mmm::StatsFormat::Json);
+  stats.report(plain);
+  auto j = json.str();
+  EXPECT_EQ(j.front(), '{');
+  EXPECT_NE(j.find("\"bytes_parsed\":" + std::to_string(text.size())),
+            std::string::npos);
+  EXPECT_NE(j.find("\"eliminate\":{\"ns\":"), std::string::npos);
+  EXPECT_NE(plain.str().find("parse: "), std::string::npos);
+  EXPECT_NE(plain.str().find("allocations: "), std::string::npos);
+}
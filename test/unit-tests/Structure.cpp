@@ -0,0 +1,141 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <Matrix.hpp>
+#include <Structure.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+enum { MAX_DIM = 120 };
+
+class StructureTest : public ::testing::Test {
+protected:
+  void SetUp() override { dim = rand() % MAX_DIM + 9; }
+
+  // Random matrix with nonzeros only inside band [i - kl, i + ku]. Floating
+  // ones are diagonally dominant, so that dense LU is accurate reference.
+  template <typename T> mmm::Matrix<T> banded(size_t kl, size_t ku) {
+    mmm::Matrix<T> m(dim);
+    for (size_t i = 0; i < dim; ++i)
+      for (size_t j = 0; j < dim; ++j) {
+        bool inside = j + kl >= i && j <= i + ku;
+        m(i, j) = inside ? T(int(rand() % 19) - 9) : T{0};
+        if constexpr (std::floating_point<T>)
+          m(i, j) /= T(kl + ku + 1);
+      }
+    for (size_t i = 0; i < dim; ++i)
+      m(i, i) = T(int(rand() % 5) + 10) * (rand() % 2 ? 1 : -1);
+    return m;
+  }
+
+  template <typename T> void expectSameDet(const mmm::Matrix<T> &m) {
+    mmm::DetPolicy scan{.structure = mmm::StructureScan::Auto};
+    if constexpr (std::integral<T>) {
+      EXPECT_TRUE(m.detBig(scan) == m.detBig());
+    } else {
+      T ref = m.det();
+      EXPECT_NEAR(m.det(scan), ref, 1e-8 * std::max(T{1}, std::abs(ref)));
+    }
+  }
+
+  std::mt19937 rand{std::random_device{}()};
+  size_t dim;
+};
+
+TEST_F(StructureTest, Bandwidths) {
+  size_t kl = rand() % 5, ku = rand() % 5;
+  auto m = banded<double>(kl, ku);
+  // Outermost diagonals may have zeros only, so put one element on each
+  m(kl, 0) = 1;
+  m(0, ku) = 1;
+  auto band = mmm::bandwidths(m.begin(), dim, dim);
+  EXPECT_EQ(band.lower, kl);
+  EXPECT_EQ(band.upper, ku);
+
+  std::fill(m.begin(), m.end(), 1.0);
+  band = mmm::bandwidths(m.begin(), dim, dim);
+  EXPECT_EQ(band.lower, dim - 1);
+  EXPECT_EQ(band.upper, dim - 1);
+}
+
+TEST_F(StructureTest, Components) {
+  // Interleaved blocks: even and odd indices
+  mmm::Matrix<int> m(dim);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j)
+      m(i, j) = (i + j) % 2 ? 0 : int(rand() % 9) + 1;
+  mmm::Bandwidths all{dim - 1, dim - 1};
+  auto blocks = mmm::components(m.begin(), dim, dim, all);
+  ASSERT_EQ(blocks.size(), 2);
+  EXPECT_EQ(blocks[0].size(), (dim + 1) / 2);
+  for (auto i : blocks[1])
+    EXPECT_EQ(i % 2, 1);
+
+  std::fill(m.begin(), m.end(), 1);
+  EXPECT_TRUE(mmm::components(m.begin(), dim, dim, all).empty());
+}
+
+TEST_F(StructureTest, TriangularAndTridiagonal) {
+  expectSameDet(banded<double>(rand() % dim, 0));
+  expectSameDet(banded<double>(0, rand() % dim));
+  expectSameDet(banded<double>(1, 1));
+  expectSameDet(banded<int>(0, rand() % dim));
+  expectSameDet(banded<long long>(1, 1));
+}
+
+TEST_F(StructureTest, BandLU) {
+  dim += 128;
+  size_t kl = rand() % 4 + 1, ku = rand() % 4 + 1;
+  auto m = banded<double>(kl, ku);
+  auto band = mmm::bandwidths(m.begin(), dim, dim);
+  ASSERT_TRUE(band.banded(dim));
+  double ref = m.det();
+  double res = mmm::bandDet(m.begin(), dim, dim, band.lower, band.upper);
+  EXPECT_NEAR(res, ref, 1e-8 * std::max(1.0, std::abs(ref)));
+  expectSameDet(m);
+}
+
+TEST_F(StructureTest, BlockDiagonal) {
+  // Dense blocks along diagonal, rows and columns then shuffled symmetrically
+  std::vector<size_t> perm(dim);
+  std::iota(perm.begin(), perm.end(), size_t{0});
+  std::shuffle(perm.begin(), perm.end(), rand);
+  size_t bs = rand() % 8 + 2;
+
+  mmm::Matrix<int> m(dim);
+  mmm::Matrix<double> f(dim);
+  for (size_t i = 0; i < dim; ++i)
+    for (size_t j = 0; j < dim; ++j) {
+      int x = i / bs == j / bs ? int(rand() % 9) + 1 : 0;
+      x += i == j ? 50 : 0;
+      m(perm[i], perm[j]) = x;
+      f(perm[i], perm[j]) = x;
+    }
+  expectSameDet(m);
+  expectSameDet(f);
+
+  mmm::DetPolicy parallel{.threads = 4,
+                          .minParallelDim = 1,
+                          .structure = mmm::StructureScan::Auto};
+  EXPECT_TRUE(m.detBig(parallel) == m.detBig());
+}
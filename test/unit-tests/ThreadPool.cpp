@@ -0,0 +1,78 @@
+// -------------------------------------------------------------------------- //
+// Copyright 2022 Yuly Tarasov
+//
+// This file is part of hwmx.
+//
+// hwmx is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// hwmx is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// hwmx. If not, see <https://www.gnu.org/licenses/>.
+// -------------------------------------------------------------------------- //
+
+#include <ThreadPool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override { threads = rand() % 8; }
+
+  std::mt19937 rand{std::random_device{}()};
+  unsigned threads;
+};
+
+TEST_F(ThreadPoolTest, Size) {
+  mmm::ThreadPool pool(threads);
+  EXPECT_EQ(pool.size(), threads);
+}
+
+TEST_F(ThreadPoolTest, Submit) {
+  mmm::ThreadPool pool(threads + 1);
+  std::vector<std::future<int>> res;
+  for (int i = 0; i < 100; ++i)
+    res.push_back(pool.submit([i] { return i * i; }));
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(res[i].get(), i * i);
+}
+
+TEST_F(ThreadPoolTest, ParallelForCoversRange) {
+  mmm::ThreadPool pool(threads);
+  size_t size = rand() % 1000;
+  std::vector<std::atomic<int>> hits(size);
+  pool.parallelFor(0, size, [&hits](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i)
+      ++hits[i];
+  });
+  for (auto &h : hits)
+    EXPECT_EQ(h, 1);
+}
+
+TEST_F(ThreadPoolTest, ParallelForGrain) {
+  mmm::ThreadPool pool(threads);
+  std::atomic<int> calls = 0;
+  pool.parallelFor(
+      0, 10, [&calls](size_t lo, size_t hi) { ++calls; }, 100);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(ThreadPoolTest, ParallelForRethrows) {
+  mmm::ThreadPool pool(threads);
+  EXPECT_THROW(pool.parallelFor(0, 100,
+                                [](size_t lo, size_t hi) {
+                                  if (hi == 100)
+                                    throw std::runtime_error("last chunk");
+                                }),
+               std::runtime_error);
+}